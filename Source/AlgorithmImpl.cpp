@@ -1,6 +1,10 @@
 #include "AlgorithmImpl.h"
 #include "CacheException.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 using namespace cache;
 
 void CacheAlgorithmQueue::setPageCount(PageCount pageCount)
@@ -29,6 +33,16 @@ PageNumber CacheAlgorithmQueue::getReplacePage()
 	return pageQueue_.front();
 }
 
+void CacheAlgorithmQueue::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	for (PageQueue::iterator item = pageQueue_.begin(); item != pageQueue_.end() && candidates.size() < maxCount; item++)
+	{
+		candidates.push_back(*item);
+	}
+}
+
 void CacheAlgorithmQueue::getPageQueue(std::vector<PageNumber>& queue) const
 {
 	queue.clear();
@@ -38,7 +52,7 @@ void CacheAlgorithmQueue::getPageQueue(std::vector<PageNumber>& queue) const
 	}
 }
 
-void caFIFO::onPageOperation(PageNumber page, PageOperation pageOperation)
+void caFIFO::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
 {
 	PageQueueLocator currentQueueItem = pageLocator_[page];
 
@@ -51,6 +65,7 @@ void caFIFO::onPageOperation(PageNumber page, PageOperation pageOperation)
 	}
 	break;
 	case PAGE_RESET:
+	case PAGE_EVICT:
 	{
 		PageQueueLocator firstQueueItem = pageQueue_.begin();
 		pageQueue_.splice(firstQueueItem, pageQueue_, currentQueueItem);
@@ -59,13 +74,14 @@ void caFIFO::onPageOperation(PageNumber page, PageOperation pageOperation)
 	}
 }
 
-void caLRU::onPageOperation(PageNumber page, PageOperation pageOperation)
+void caLRU::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
 {
 	PageQueueLocator currentQueueItem = pageLocator_[page];
 
 	switch (pageOperation)
 	{
 	case PAGE_RESET:
+	case PAGE_EVICT:
 	{
 		PageQueueLocator firstQueueItem = pageQueue_.begin();
 		pageQueue_.splice(firstQueueItem, pageQueue_, currentQueueItem);
@@ -82,274 +98,2776 @@ void caLRU::onPageOperation(PageNumber page, PageOperation pageOperation)
 	}
 }
 
-void caLFU::onPageOperation(PageNumber page, PageOperation pageOperation)
+void caLFU::setPageCount(PageCount pageCount)
 {
-	PageQueueLocator currentQueueItem = pageLocator_[page];
+	buckets_.clear();
+	freeSlots_.clear();
+	slots_.clear();
+	slots_.resize(pageCount);
+	accessCount_ = 0;
 
-	switch (pageOperation)
+	for (SlotIndex slot = 0; slot < pageCount; slot++)
 	{
-	case PAGE_RESET:
+		slots_[slot].isFree = true;
+		slots_[slot].isFirstAccess = false;
+		slots_[slot].locator = freeSlots_.insert(freeSlots_.end(), slot);
+	}
+}
+
+void caLFU::reset()
+{
+	setPageCount(slots_.size());
+}
+
+void caLFU::removeFromBucket(SlotIndex slot)
+{
+	SlotEntry& entry = slots_[slot];
+
+	if (entry.isFree)
 	{
-		PageQueueLocator firstQueueItem = pageQueue_.begin();
-		pageQueue_.splice(firstQueueItem, pageQueue_, currentQueueItem);
+		freeSlots_.erase(entry.locator);
+		entry.isFree = false;
+		return;
 	}
-	break;
-	case PAGE_READ:
-	case PAGE_WRITE:
-	case PAGE_REPLACE:
+
+	entry.bucket->slots.erase(entry.locator);
+	if (entry.bucket->slots.empty())
+	{
+		buckets_.erase(entry.bucket);
+	}
+}
+
+void caLFU::moveToBucket(SlotIndex slot, unsigned long frequency)
+{
+	SlotEntry& entry = slots_[slot];
+
+	//The target bucket is usually the next one, so the search costs O(1)
+	BucketList::iterator position = buckets_.begin();
+	if (!entry.isFree)
 	{
-		PageQueueLocator nextQueueItem = currentQueueItem;
-		nextQueueItem++;
-		if (nextQueueItem != pageQueue_.end())
+		position = entry.bucket;
+		if (position->frequency > frequency)
 		{
-			pageQueue_.splice(currentQueueItem, pageQueue_, nextQueueItem);
+			position = buckets_.begin();
 		}
-		
 	}
-	break;
+
+	while (position != buckets_.end() && position->frequency < frequency)
+	{
+		position++;
+	}
+
+	if (position == buckets_.end() || position->frequency != frequency)
+	{
+		position = buckets_.insert(position, Bucket{ frequency, SlotList() });
+	}
+
+	if (entry.isFree)
+	{
+		position->slots.splice(position->slots.end(), freeSlots_, entry.locator);
+		entry.isFree = false;
 	}
+	else
+	{
+		BucketList::iterator oldBucket = entry.bucket;
+		position->slots.splice(position->slots.end(), oldBucket->slots, entry.locator);
+		if (oldBucket->slots.empty())
+		{
+			buckets_.erase(oldBucket);
+		}
+	}
+
+	entry.bucket = position;
 }
 
-void caMRU::onPageOperation(PageNumber page, PageOperation pageOperation)
+void caLFU::age()
 {
-	if (pageOperation != PAGE_FLUSH)
+	//Frequencies are multiplied by the decay factor, the buckets that get the same frequency are merged
+	BucketList::iterator bucket = buckets_.begin();
+	while (bucket != buckets_.end())
 	{
-		PageQueueLocator currentQueueItem = pageLocator_[page];
-		PageQueueLocator firstQueueItem = pageQueue_.begin();
-		pageQueue_.splice(firstQueueItem, pageQueue_, currentQueueItem);
+		bucket->frequency = (unsigned long)(bucket->frequency * decay_);
+
+		BucketList::iterator next = bucket;
+		next++;
+		if (bucket != buckets_.begin())
+		{
+			BucketList::iterator previous = bucket;
+			previous--;
+			if (previous->frequency == bucket->frequency)
+			{
+				for (SlotIndex slot : bucket->slots)
+				{
+					slots_[slot].bucket = previous;
+				}
+				previous->slots.splice(previous->slots.end(), bucket->slots);
+				buckets_.erase(bucket);
+			}
+		}
+		bucket = next;
 	}
+
+	accessCount_ = 0;
 }
 
-void caClock::setPageCount(PageCount pageCount)
+void caLFU::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
 {
-	listPages_.clear();
-	listPages_.resize(pageCount, false);
-	currentPage_ = 0;
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (entry.isFirstAccess)
+		{
+			entry.isFirstAccess = false;
+		}
+		else if (!entry.isFree)
+		{
+			moveToBucket(page, entry.bucket->frequency + 1);
+			accessCount_++;
+		}
+		break;
+
+	case PAGE_REPLACE:
+		moveToBucket(page, 1);
+		entry.isFirstAccess = true;
+		accessCount_++;
+		break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		removeFromBucket(page);
+		entry.isFree = true;
+		entry.isFirstAccess = false;
+		entry.locator = freeSlots_.insert(freeSlots_.begin(), page);
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+
+	if (accessCount_ >= 10 * slots_.size())
+	{
+		age();
+	}
 }
 
-void caClock::onPageOperation(PageNumber page, PageOperation pageOperation)
+PageNumber caLFU::getReplacePage()
 {
-	if (pageOperation != PAGE_FLUSH)
+	if (!freeSlots_.empty())
 	{
-		listPages_[page] = true;
+		return freeSlots_.front();
 	}
+
+	return buckets_.front().slots.front();
 }
 
-PageNumber caClock::getReplacePage()
+void caLFU::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
 {
-	auto getNextPage = [this](PageNumber currentPage) -> PageNumber
+	candidates.clear();
+
+	for (SlotList::iterator item = freeSlots_.begin(); item != freeSlots_.end() && candidates.size() < maxCount; item++)
 	{
-		currentPage++;
-		if (currentPage == this->listPages_.size())
+		candidates.push_back(*item);
+	}
+
+	for (BucketList::iterator bucket = buckets_.begin(); bucket != buckets_.end() && candidates.size() < maxCount; bucket++)
+	{
+		for (SlotList::iterator item = bucket->slots.begin(); item != bucket->slots.end() && candidates.size() < maxCount; item++)
 		{
-			currentPage = 0;
+			candidates.push_back(*item);
 		}
-		return currentPage;
-	};
+	}
+}
 
-	PageNumber savedPage = currentPage_;
-	currentPage_ = getNextPage(currentPage_);
-	if (listPages_[savedPage] == false)
+void caLFU::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "decay") != 0)
 	{
-		return savedPage;
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	if (paramValue <= 0 || paramValue > 1)
+	{
+		throw cache_exception(ERR_PARAMETER_VALUE);
 	}
-	
-	while (currentPage_ != savedPage && listPages_[currentPage_] == true)
+
+	decay_ = paramValue;
+}
+
+AlgoritmParameterValue caLFU::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "decay") != 0)
 	{
-		listPages_[currentPage_] = false;
-		currentPage_ = getNextPage(currentPage_);
+		throw cache_exception(ERR_PARAMETER_NAME);
 	}
 
-	return currentPage_;
+	return decay_;
 }
 
-void caClock::reset()
+void caMRU::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
 {
-	setPageCount(listPages_.size());
+	if (pageOperation != PAGE_FLUSH)
+	{
+		PageQueueLocator currentQueueItem = pageLocator_[page];
+		PageQueueLocator firstQueueItem = pageQueue_.begin();
+		pageQueue_.splice(firstQueueItem, pageQueue_, currentQueueItem);
+	}
 }
 
-caNRU::~caNRU()
+static unsigned findFirstBit(uint64_t value)
 {
-	std::unique_lock<std::mutex> lock(mutexTimer_);
-	isRun_ = false;
-	cvWaitTimer_.notify_all();
-	lock.unlock();
-	timer_.join();
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#else
+	return __builtin_ctzll(value);
+#endif
 }
 
-void caNRU::setPageCount(PageCount pageCount)
+static uint64_t lowBits(size_t count)
+{
+	return count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+}
+
+void ReferenceBitmap::resize(size_t size)
+{
+	size_ = size;
+	words_.assign((size + WORD_BITS - 1) / WORD_BITS, 0);
+	summary_.assign((words_.size() + WORD_BITS - 1) / WORD_BITS, 0);
+}
+
+size_t ReferenceBitmap::size() const
+{
+	return size_;
+}
+
+bool ReferenceBitmap::test(size_t index) const
 {
-	std::lock_guard<std::mutex> lock(mutexTimer_);
-	listPages_.clear();
-	listPages_.resize(pageCount, 0);
+	return (words_[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
 }
 
-void caNRU::onPageOperation(PageNumber page, PageOperation pageOperation)
+void ReferenceBitmap::set(size_t index)
 {
-	if (!timer_.joinable())
+	size_t word = index / WORD_BITS;
+	words_[word] |= Word(1) << (index % WORD_BITS);
+	if (words_[word] == ~Word(0))
 	{
-		isRun_ = true;
-		timer_ = std::thread(&caNRU::threadTimer, this);
+		summary_[word / WORD_BITS] |= Word(1) << (word % WORD_BITS);
 	}
+}
 
-	switch (pageOperation)
+size_t ReferenceBitmap::findNotFullWord(size_t word, size_t endWord) const
+{
+	while (word < endWord)
 	{
-	case cache::PAGE_READ:
-		listPages_[page].bitValue.referenced = 1;
-		break;
-	case cache::PAGE_WRITE:
-		listPages_[page].bitValue.referenced = 1;
-		listPages_[page].bitValue.modified = 1;
-		break;
-	case cache::PAGE_REPLACE:
-		listPages_[page].bitValue.modified = 0;
-		listPages_[page].bitValue.referenced = 1;
-		break;
-	case cache::PAGE_RESET:
-		listPages_[page].bitValue.referenced = 0;
-		listPages_[page].bitValue.modified = 0;
-		break;
-	case cache::PAGE_FLUSH:
-		listPages_[page].bitValue.modified = 0;
-		break;
+		Word notFull = ~summary_[word / WORD_BITS] & ~lowBits(word % WORD_BITS);
+		if (notFull != 0)
+		{
+			return std::min(endWord, (word & ~(WORD_BITS - 1)) + findFirstBit(notFull));
+		}
+		word = (word & ~(WORD_BITS - 1)) + WORD_BITS;
 	}
+
+	return endWord;
 }
 
-PageNumber caNRU::getReplacePage()
+size_t ReferenceBitmap::sweep(size_t begin, size_t end)
 {
-	unsigned char minValue = 0xFF;
-	PageNumber retPage = listPages_.size();
-	for (size_t i = 0; i < listPages_.size(); i++)
+	size_t index = begin;
+
+	while (index < end)
 	{
-		if (listPages_[i].value < minValue)
+		size_t word = index / WORD_BITS;
+		size_t bit = index % WORD_BITS;
+
+		if (bit == 0 && end - index >= WORD_BITS)
 		{
-			minValue = listPages_[i].value;
-			retPage = i;
-			if (minValue == 0)
+			//The fully referenced words are found by the summary and cleared at once
+			size_t notFullWord = findNotFullWord(word, end / WORD_BITS);
+			if (notFullWord > word)
 			{
-				break;
+				std::fill(words_.begin() + word, words_.begin() + notFullWord, 0);
+				for (size_t i = word; i < notFullWord; i++)
+				{
+					summary_[i / WORD_BITS] &= ~(Word(1) << (i % WORD_BITS));
+				}
+				index = notFullWord * WORD_BITS;
+				continue;
 			}
 		}
+
+		size_t endBit = std::min(WORD_BITS, end - word * WORD_BITS);
+		Word range = lowBits(endBit) & ~lowBits(bit);
+		Word clear = ~words_[word] & range;
+
+		if (clear != 0)
+		{
+			size_t found = findFirstBit(clear);
+			words_[word] &= ~(range & lowBits(found));
+			return word * WORD_BITS + found;
+		}
+
+		words_[word] &= ~range;
+		summary_[word / WORD_BITS] &= ~(Word(1) << (word % WORD_BITS));
+		index = word * WORD_BITS + endBit;
 	}
 
-	return retPage;
+	return end;
 }
 
-void caNRU::reset()
+void caClock::setPageCount(PageCount pageCount)
+{
+	listPages_.resize(pageCount);
+	currentPage_ = 0;
+}
+
+void caClock::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
 {
-	for (auto& item : listPages_)
+	if (pageOperation != PAGE_FLUSH)
 	{
-		item.value = 0;
+		listPages_.set(page);
 	}
 }
 
-void caNRU::setTimerInterval(unsigned long intervalMillisec)
+PageNumber caClock::getReplacePage()
 {
-	std::lock_guard<std::mutex> lock(mutexTimer_);
-	timerInterval_ = intervalMillisec;
-	cvWaitTimer_.notify_all();
+	PageNumber savedPage = currentPage_;
+	currentPage_ = savedPage + 1 == listPages_.size() ? 0 : savedPage + 1;
+	if (!listPages_.test(savedPage))
+	{
+		return savedPage;
+	}
+
+	//The hand clears the reference bits up to the first page that is not referenced; it stops at the saved page
+	if (currentPage_ > savedPage)
+	{
+		currentPage_ = listPages_.sweep(currentPage_, listPages_.size());
+		if (currentPage_ < listPages_.size())
+		{
+			return currentPage_;
+		}
+		currentPage_ = 0;
+	}
+
+	currentPage_ = listPages_.sweep(currentPage_, savedPage);
+	return currentPage_;
 }
 
-void caNRU::threadTimer()
+void caClock::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
 {
-	while (isRun_)
+	candidates.clear();
+
+	//The pages without the reference bit in the order the hand meets them; the hand does not move.
+	//A referenced page gets its second chance first, so it is not a candidate
+	size_t window = std::min(listPages_.size(), 4 * maxCount);
+	for (size_t step = 0; step < window && candidates.size() < maxCount; step++)
 	{
-		std::unique_lock<std::mutex> lock(mutexTimer_);
-		cvWaitTimer_.wait_for(lock, std::chrono::milliseconds(timerInterval_));
-		for (auto& item : listPages_)
+		PageNumber page = (currentPage_ + step) % listPages_.size();
+		if (!listPages_.test(page))
 		{
-			item.bitValue.referenced = 0;
+			candidates.push_back(page);
 		}
 	}
 }
 
-void caNRU::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+void caClock::reset()
 {
-	if (::strcmp(paramName, "timeout") != 0)
+	setPageCount(listPages_.size());
+}
+
+void caClockPro::setPageCount(PageCount pageCount)
+{
+	clock_.clear();
+	pages_.clear();
+	freeSlots_.clear();
+	slots_.clear();
+	slots_.resize(pageCount);
+	count_[PAGE_HOT] = count_[PAGE_COLD] = count_[PAGE_TEST] = 0;
+	coldTarget_ = std::max<size_t>(1, pageCount / 100);
+	handHot_ = handCold_ = handTest_ = clock_.end();
+
+	for (SlotIndex slot = 0; slot < pageCount; slot++)
 	{
-		throw cache_exception(ERR_PARAMETER_NAME);
+		slots_[slot].isFree = true;
+		slots_[slot].isFirstAccess = false;
+		slots_[slot].freeLocator = freeSlots_.insert(freeSlots_.end(), slot);
 	}
+}
 
-	if (paramValue <= 0)
+void caClockPro::reset()
+{
+	setPageCount(slots_.size());
+}
+
+caClockPro::ClockHand caClockPro::getNext(ClockHand hand)
+{
+	hand++;
+	if (hand == clock_.end())
 	{
-		throw cache_exception(ERR_PARAMETER_VALUE);
-		setTimerInterval((unsigned long)paramValue);
+		hand = clock_.begin();
 	}
+	return hand;
 }
 
-AlgoritmParameterValue caNRU::getParameter(const char* paramName) const
+void caClockPro::setType(ClockEntry& entry, PageType type)
 {
-	if (::strcmp(paramName, "timeout") != 0)
+	count_[entry.type]--;
+	count_[type]++;
+	entry.type = type;
+}
+
+void caClockPro::insertEntry(PageNumber page, SlotIndex slot, PageType type)
+{
+	//A new entry is placed at the head of the clock, which is just behind the hot hand
+	ClockHand entry = clock_.insert(clock_.empty() ? clock_.end() : handHot_, ClockEntry{ page, slot, type, false, type == PAGE_COLD });
+	count_[type]++;
+
+	if (clock_.size() == 1)
 	{
-		throw cache_exception(ERR_PARAMETER_NAME);
+		handHot_ = handCold_ = handTest_ = entry;
 	}
 
-	return timerInterval_;
+	pages_[page] = entry;
+	slots_[slot].entry = entry;
 }
 
-caRandom::caRandom(unsigned int seedValue)
+void caClockPro::removeEntry(ClockHand entry)
 {
-	seed_ = seedValue;
+	ClockHand next = clock_.size() > 1 ? getNext(entry) : clock_.end();
 
-	if (seed_ == 0)
+	if (handHot_ == entry)
 	{
-		std::random_device rd;
-		seed_ = rd();
-		generator_.seed(seed_);
+		handHot_ = next;
 	}
-	else
+	if (handCold_ == entry)
 	{
-		generator_.seed(seed_);
+		handCold_ = next;
+	}
+	if (handTest_ == entry)
+	{
+		handTest_ = next;
 	}
 
-	pageCount_ = 0;
+	count_[entry->type]--;
+	pages_.erase(entry->page);
+	clock_.erase(entry);
 }
 
-void caRandom::setSeed(unsigned int seedValue)
+void caClockPro::terminateTest(ClockHand entry)
 {
-	seed_ = seedValue;
-
-	if (seed_ == 0)
+	if (entry->type == PAGE_TEST)
 	{
-		std::random_device rd;
-		seed_ = rd();
-		generator_.seed(seed_);
+		//The non-resident page was not reused during its test period, the cold part doesn't need to be larger
+		removeEntry(entry);
+		if (coldTarget_ > 1)
+		{
+			coldTarget_--;
+		}
 	}
-	else
+	else if (entry->type == PAGE_COLD)
 	{
-		generator_.seed(seed_);
+		entry->isInTest = false;
 	}
 }
 
-
-void caRandom::setPageCount(PageCount pageCount)
+void caClockPro::runHandHot()
 {
-	pageCount_ = pageCount;
+	ClockHand entry = handHot_;
+	handHot_ = getNext(handHot_);
+
+	if (entry->type == PAGE_HOT)
+	{
+		if (entry->isReferenced)
+		{
+			entry->isReferenced = false;
+		}
+		else
+		{
+			setType(*entry, PAGE_COLD);
+		}
+	}
+	else
+	{
+		terminateTest(entry);
+	}
 }
 
-PageNumber caRandom::getReplacePage()
+void caClockPro::runHandTest()
 {
-	std::uniform_int_distribution<PageNumber> numbers(0, pageCount_ - 1);
-	return numbers(generator_);
+	ClockHand entry = handTest_;
+	handTest_ = getNext(handTest_);
+	terminateTest(entry);
 }
 
-void caRandom::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+void caClockPro::evictEntry(ClockHand entry)
 {
-	if (::strcmp(paramName, "seed") != 0)
+	if (entry->type == PAGE_COLD && entry->isInTest)
 	{
-		throw cache_exception(ERR_PARAMETER_NAME);
-	}
+		//The evicted cold page stays on the clock as a non-resident page until its test period is over
+		if (handCold_ == entry)
+		{
+			handCold_ = getNext(handCold_);
+		}
+		setType(*entry, PAGE_TEST);
+		entry->slot = INVALID_SLOT;
+		entry->isReferenced = false;
 
-	setSeed((unsigned int)paramValue);
+		while (count_[PAGE_TEST] > slots_.size())
+		{
+			runHandTest();
+		}
+	}
+	else
+	{
+		removeEntry(entry);
+	}
 }
 
-AlgoritmParameterValue caRandom::getParameter(const char* paramName) const
+void caClockPro::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
 {
-	if (::strcmp(paramName, "seed") != 0)
+	SlotEntry& slot = slots_[page];
+
+	switch (pageOperation)
 	{
-		throw cache_exception(ERR_PARAMETER_NAME);
-	}
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (slot.isFirstAccess)
+		{
+			slot.isFirstAccess = false;
+		}
+		else if (!slot.isFree)
+		{
+			slot.entry->isReferenced = true;
+		}
+		break;
+
+	case PAGE_REPLACE:
+	{
+		if (slot.isFree)
+		{
+			freeSlots_.erase(slot.freeLocator);
+			slot.isFree = false;
+		}
+		else
+		{
+			evictEntry(slot.entry);
+		}
+
+		auto found = pages_.find(storagePage);
+		if (found != pages_.end() && found->second->type == PAGE_TEST)
+		{
+			//The page is reused during its test period: it becomes hot and the cold part grows
+			removeEntry(found->second);
+			if (coldTarget_ < slots_.size())
+			{
+				coldTarget_++;
+			}
+			insertEntry(storagePage, page, PAGE_HOT);
+		}
+		else
+		{
+			insertEntry(storagePage, page, PAGE_COLD);
+		}
+
+		while (count_[PAGE_HOT] > slots_.size() - coldTarget_)
+		{
+			runHandHot();
+		}
+
+		slot.isFirstAccess = true;
+	}
+	break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		if (!slot.isFree)
+		{
+			if (pageOperation == PAGE_EVICT)
+			{
+				evictEntry(slot.entry);
+			}
+			else
+			{
+				removeEntry(slot.entry);
+			}
+			slot.isFree = true;
+			slot.isFirstAccess = false;
+			slot.freeLocator = freeSlots_.insert(freeSlots_.begin(), page);
+		}
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber caClockPro::getReplacePage()
+{
+	if (!freeSlots_.empty())
+	{
+		return freeSlots_.front();
+	}
+
+	//The cold hand stops at the first cold page without the reference bit
+	for (size_t step = 0; step < 4 * clock_.size(); step++)
+	{
+		ClockEntry& entry = *handCold_;
+
+		if (entry.type == PAGE_COLD)
+		{
+			if (!entry.isReferenced)
+			{
+				return entry.slot;
+			}
+
+			entry.isReferenced = false;
+
+			if (entry.isInTest)
+			{
+				//The cold page is reused during its test period: it becomes hot
+				setType(entry, PAGE_HOT);
+
+				while (count_[PAGE_HOT] > slots_.size() - coldTarget_)
+				{
+					runHandHot();
+				}
+			}
+			else
+			{
+				entry.isInTest = true;
+			}
+		}
+
+		handCold_ = getNext(handCold_);
+	}
+
+	//Every resident page was referenced, the victim is the first resident page after the cold hand
+	while (handCold_->type == PAGE_TEST)
+	{
+		handCold_ = getNext(handCold_);
+	}
+	return handCold_->slot;
+}
+
+void caClockPro::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	//The free slots, then the cold pages without the reference bit in the order of the cold hand; the hands do not move.
+	//The hot pages and the referenced cold pages are not evicted before the hands pass them
+	for (std::list<SlotIndex>::iterator item = freeSlots_.begin(); item != freeSlots_.end() && candidates.size() < maxCount; item++)
+	{
+		candidates.push_back(*item);
+	}
+
+	ClockHand hand = handCold_ != clock_.end() ? handCold_ : clock_.begin();
+	for (size_t step = 0; step < clock_.size() && candidates.size() < maxCount; step++, hand = getNext(hand))
+	{
+		if (hand->type == PAGE_COLD && !hand->isReferenced)
+		{
+			candidates.push_back(hand->slot);
+		}
+	}
+}
+
+AlgoritmParameterValue caClockPro::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "cold") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	return (AlgoritmParameterValue)coldTarget_;
+}
+
+void caGreedyDual::setPageCount(PageCount pageCount)
+{
+	queue_.clear();
+	slots_.clear();
+	slots_.resize(pageCount);
+	inflation_ = 0;
+	averageCost_ = 1;
+	sequence_ = 0;
+
+	for (SlotIndex slot = 0; slot < pageCount; slot++)
+	{
+		slots_[slot].isFree = true;
+		slots_[slot].isFirstAccess = false;
+		slots_[slot].cost = 0;
+		slots_[slot].locator = queue_.insert(PriorityKey(-1, slot, slot)).first;
+	}
+	sequence_ = pageCount;
+}
+
+void caGreedyDual::reset()
+{
+	setPageCount(slots_.size());
+}
+
+void caGreedyDual::setPriority(SlotIndex slot)
+{
+	//The sequence number makes the pages of equal priority be evicted in LRU order
+	SlotEntry& entry = slots_[slot];
+	queue_.erase(entry.locator);
+	entry.locator = queue_.insert(PriorityKey(inflation_ + entry.cost, sequence_++, slot)).first;
+}
+
+void caGreedyDual::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (entry.isFirstAccess)
+		{
+			entry.isFirstAccess = false;
+		}
+		else if (!entry.isFree)
+		{
+			setPriority(page);
+		}
+		break;
+
+	case PAGE_REPLACE:
+		if (!entry.isFree)
+		{
+			inflation_ = std::max(inflation_, std::get<0>(*entry.locator));
+		}
+
+		//The cost is unknown until the page is loaded
+		entry.isFree = false;
+		entry.isFirstAccess = true;
+		entry.cost = averageCost_;
+		setPriority(page);
+		break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		if (pageOperation == PAGE_EVICT && !entry.isFree)
+		{
+			inflation_ = std::max(inflation_, std::get<0>(*entry.locator));
+		}
+		queue_.erase(entry.locator);
+		entry.isFree = true;
+		entry.isFirstAccess = false;
+		entry.cost = 0;
+		entry.locator = queue_.insert(PriorityKey(-1, 0, page)).first;
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+void caGreedyDual::onPageCost(PageNumber page, AlgoritmParameterValue cost)
+{
+	SlotEntry& entry = slots_[page];
+
+	if (entry.isFree || cost < 0)
+	{
+		return;
+	}
+
+	averageCost_ += (cost - averageCost_) / 16;
+	entry.cost = cost;
+	setPriority(page);
+}
+
+PageNumber caGreedyDual::getReplacePage()
+{
+	return std::get<2>(*queue_.begin());
+}
+
+void caGreedyDual::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	for (PriorityQueue::iterator item = queue_.begin(); item != queue_.end() && candidates.size() < maxCount; item++)
+	{
+		candidates.push_back(std::get<2>(*item));
+	}
+}
+
+AlgoritmParameterValue caGreedyDual::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "inflation") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	return inflation_;
+}
+
+void caLRUK::setPageCount(PageCount pageCount)
+{
+	queue_.clear();
+	history_.clear();
+	retained_.clear();
+	slots_.clear();
+	slots_.resize(pageCount);
+	time_ = 0;
+
+	for (SlotIndex slot = 0; slot < pageCount; slot++)
+	{
+		slots_[slot].isFree = true;
+		slots_[slot].isFirstAccess = false;
+		slots_[slot].page = INVALID_PAGE;
+		slots_[slot].locator = queue_.insert(PriorityKey(0, 0, slot)).first;
+	}
+}
+
+void caLRUK::reset()
+{
+	setPageCount(slots_.size());
+}
+
+void caLRUK::reference(PageHistory& history)
+{
+	time_++;
+
+	if (history.references.empty())
+	{
+		history.references.assign(k_, 0);
+		history.references[0] = time_;
+	}
+	else if (time_ - history.lastAccess > correlatedPeriod_)
+	{
+		//The correlated references are collapsed into one, so the history is shifted by the correlation period
+		ReferenceTime correlation = history.lastAccess - history.references[0];
+		for (size_t i = k_ - 1; i > 0; i--)
+		{
+			history.references[i] = history.references[i - 1] != 0 ? history.references[i - 1] + correlation : 0;
+		}
+		history.references[0] = time_;
+	}
+
+	history.lastAccess = time_;
+}
+
+void caLRUK::setPriority(SlotIndex slot, const PageHistory& history)
+{
+	SlotEntry& entry = slots_[slot];
+	queue_.erase(entry.locator);
+	entry.locator = queue_.insert(PriorityKey(history.references[k_ - 1], history.references[0], slot)).first;
+}
+
+void caLRUK::retainHistory(PageNumber page)
+{
+	HistoryTable::iterator item = history_.find(page);
+	if (item == history_.end())
+	{
+		return;
+	}
+
+	item->second.isResident = false;
+	item->second.retainedLocator = retained_.insert(retained_.end(), page);
+	trimHistory();
+}
+
+void caLRUK::trimHistory()
+{
+	size_t limit = (size_t)(slots_.size() * ratioRetained_);
+
+	while (retained_.size() > limit)
+	{
+		history_.erase(retained_.front());
+		retained_.pop_front();
+	}
+}
+
+void caLRUK::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (entry.isFirstAccess)
+		{
+			entry.isFirstAccess = false;
+		}
+		else if (!entry.isFree)
+		{
+			PageHistory& history = history_[entry.page];
+			reference(history);
+			setPriority(page, history);
+		}
+		break;
+
+	case PAGE_REPLACE:
+	{
+		if (!entry.isFree)
+		{
+			retainHistory(entry.page);
+		}
+
+		PageHistory& history = history_[storagePage];
+		if (!history.references.empty() && !history.isResident)
+		{
+			retained_.erase(history.retainedLocator);
+		}
+		history.isResident = true;
+		reference(history);
+
+		entry.isFree = false;
+		entry.isFirstAccess = true;
+		entry.page = storagePage;
+		setPriority(page, history);
+	}
+	break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		if (!entry.isFree)
+		{
+			if (pageOperation == PAGE_EVICT)
+			{
+				retainHistory(entry.page);
+			}
+			else
+			{
+				history_.erase(entry.page);
+			}
+		}
+		queue_.erase(entry.locator);
+		entry.isFree = true;
+		entry.isFirstAccess = false;
+		entry.page = INVALID_PAGE;
+		entry.locator = queue_.insert(PriorityKey(0, 0, page)).first;
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber caLRUK::getReplacePage()
+{
+	//The pages that have less than K references go first; the pages within the correlated reference period are not evicted
+	for (const PriorityKey& key : queue_)
+	{
+		const SlotEntry& entry = slots_[std::get<2>(key)];
+
+		if (entry.isFree || time_ - history_[entry.page].lastAccess > correlatedPeriod_)
+		{
+			return std::get<2>(key);
+		}
+	}
+
+	return std::get<2>(*queue_.begin());
+}
+
+void caLRUK::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	//The slots in the order of the queue, without the pages within the correlated reference period
+	for (PriorityQueue::iterator item = queue_.begin(); item != queue_.end() && candidates.size() < maxCount; item++)
+	{
+		const SlotEntry& entry = slots_[std::get<2>(*item)];
+
+		if (entry.isFree || time_ - history_.find(entry.page)->second.lastAccess > correlatedPeriod_)
+		{
+			candidates.push_back(std::get<2>(*item));
+		}
+	}
+}
+
+void caLRUK::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "k") == 0)
+	{
+		if (paramValue < 1 || paramValue > K_MAX)
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+		k_ = (size_t)paramValue;
+
+		//The history is kept: the oldest references are dropped or the unknown ones are added
+		for (auto& item : history_)
+		{
+			if (!item.second.references.empty())
+			{
+				item.second.references.resize(k_, 0);
+			}
+		}
+
+		for (SlotIndex slot = 0; slot < slots_.size(); slot++)
+		{
+			if (!slots_[slot].isFree)
+			{
+				setPriority(slot, history_[slots_[slot].page]);
+			}
+		}
+	}
+	else if (::strcmp(paramName, "crp") == 0)
+	{
+		if (paramValue < 0)
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+		correlatedPeriod_ = (ReferenceTime)paramValue;
+	}
+	else if (::strcmp(paramName, "history") == 0)
+	{
+		if (paramValue < 0)
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+		ratioRetained_ = paramValue;
+		trimHistory();
+	}
+	else
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+}
+
+AlgoritmParameterValue caLRUK::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "k") == 0)
+	{
+		return (AlgoritmParameterValue)k_;
+	}
+	else if (::strcmp(paramName, "crp") == 0)
+	{
+		return (AlgoritmParameterValue)correlatedPeriod_;
+	}
+	else if (::strcmp(paramName, "history") == 0)
+	{
+		return ratioRetained_;
+	}
+
+	throw cache_exception(ERR_PARAMETER_NAME);
+}
+
+void caNRU::setPageCount(PageCount pageCount)
+{
+	for (unsigned i = 0; i < 2; i++)
+	{
+		referenced_[i].clear();
+		notReferenced_[i].clear();
+	}
+
+	slots_.resize(pageCount);
+	for (SlotIndex slot = 0; slot < pageCount; slot++)
+	{
+		slots_[slot].epoch = 0;
+		slots_[slot].isModified = false;
+		slots_[slot].locator = notReferenced_[0].insert(notReferenced_[0].end(), slot);
+	}
+
+	epoch_ = 1;
+	epochStart_ = std::chrono::steady_clock::now();
+}
+
+std::list<SlotIndex>& caNRU::getList(const SlotEntry& entry)
+{
+	return entry.epoch == epoch_ ? referenced_[entry.isModified] : notReferenced_[entry.isModified];
+}
+
+void caNRU::moveSlot(SlotIndex slot, Epoch epoch, bool isModified, bool isFront)
+{
+	SlotEntry& entry = slots_[slot];
+	getList(entry).erase(entry.locator);
+
+	entry.epoch = epoch;
+	entry.isModified = isModified;
+
+	std::list<SlotIndex>& list = getList(entry);
+	entry.locator = list.insert(isFront ? list.begin() : list.end(), slot);
+}
+
+void caNRU::nextEpoch()
+{
+	//The iterators stay valid after splice, and the old epoch of the slots now means "not referenced"
+	for (unsigned i = 0; i < 2; i++)
+	{
+		notReferenced_[i].splice(notReferenced_[i].end(), referenced_[i]);
+	}
+
+	epoch_++;
+	epochStart_ = std::chrono::steady_clock::now();
+}
+
+void caNRU::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case cache::PAGE_READ:
+		if (entry.epoch != epoch_)
+		{
+			moveSlot(page, epoch_, entry.isModified);
+		}
+		break;
+	case cache::PAGE_WRITE:
+		if (entry.epoch != epoch_ || !entry.isModified)
+		{
+			moveSlot(page, epoch_, true);
+		}
+		break;
+	case cache::PAGE_REPLACE:
+		moveSlot(page, epoch_, false);
+		break;
+	case cache::PAGE_RESET:
+	case cache::PAGE_EVICT:
+		moveSlot(page, 0, false, true);
+		break;
+	case cache::PAGE_FLUSH:
+		if (entry.isModified)
+		{
+			moveSlot(page, entry.epoch, false);
+		}
+		break;
+	}
+}
+
+PageNumber caNRU::getReplacePage()
+{
+	if (slots_.empty())
+	{
+		return 0;
+	}
+
+	if (std::chrono::steady_clock::now() - epochStart_ >= std::chrono::milliseconds(timerInterval_))
+	{
+		nextEpoch();
+	}
+
+	//If all pages were referenced in the current epoch, the next epoch begins
+	for (;;)
+	{
+		for (unsigned i = 0; i < 2; i++)
+		{
+			if (!notReferenced_[i].empty())
+			{
+				return notReferenced_[i].front();
+			}
+		}
+
+		nextEpoch();
+	}
+}
+
+void caNRU::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	//The slots that are not referenced, from the lowest class; the epoch does not change. When the epoch is over,
+	//the slots referenced in it follow the not referenced slots of their class, as after the next epoch begins
+	bool isEpochOver = std::chrono::steady_clock::now() - epochStart_ >= std::chrono::milliseconds(timerInterval_);
+
+	for (unsigned i = 0; i < 2; i++)
+	{
+		for (std::list<SlotIndex>* list : { &notReferenced_[i], &referenced_[i] })
+		{
+			if (list == &referenced_[i] && !isEpochOver)
+			{
+				continue;
+			}
+
+			for (std::list<SlotIndex>::iterator item = list->begin(); item != list->end() && candidates.size() < maxCount; item++)
+			{
+				candidates.push_back(*item);
+			}
+		}
+	}
+}
+
+void caNRU::reset()
+{
+	setPageCount(slots_.size());
+}
+
+void caNRU::setTimerInterval(unsigned long intervalMillisec)
+{
+	timerInterval_ = intervalMillisec;
+}
+
+void caNRU::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "timeout") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	if (paramValue <= 0)
+	{
+		throw cache_exception(ERR_PARAMETER_VALUE);
+	}
+
+	setTimerInterval((unsigned long)paramValue);
+}
+
+AlgoritmParameterValue caNRU::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "timeout") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	return timerInterval_;
+}
+
+caRandom::caRandom(unsigned int seedValue)
+{
+	seed_ = seedValue;
+
+	if (seed_ == 0)
+	{
+		std::random_device rd;
+		seed_ = rd();
+		generator_.seed(seed_);
+	}
+	else
+	{
+		generator_.seed(seed_);
+	}
+
+	pageCount_ = 0;
+}
+
+void caRandom::setSeed(unsigned int seedValue)
+{
+	seed_ = seedValue;
+
+	if (seed_ == 0)
+	{
+		std::random_device rd;
+		seed_ = rd();
+		generator_.seed(seed_);
+	}
+	else
+	{
+		generator_.seed(seed_);
+	}
+}
+
+
+void caRandom::setPageCount(PageCount pageCount)
+{
+	pageCount_ = pageCount;
+}
+
+PageNumber caRandom::getReplacePage()
+{
+	std::uniform_int_distribution<PageNumber> numbers(0, pageCount_ - 1);
+	return numbers(generator_);
+}
+
+void caRandom::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	if (pageCount_ == 0)
+	{
+		return;
+	}
+
+	//The next victims are drawn by a copy of the generator, so the victims of getReplacePage do not change
+	std::mt19937 generator = generator_;
+	std::uniform_int_distribution<PageNumber> numbers(0, pageCount_ - 1);
+
+	for (size_t attempt = 0; attempt < 2 * maxCount && candidates.size() < maxCount; attempt++)
+	{
+		PageNumber page = numbers(generator);
+		if (std::find(candidates.begin(), candidates.end(), page) == candidates.end())
+		{
+			candidates.push_back(page);
+		}
+	}
+}
+
+void caRandom::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "seed") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	setSeed((unsigned int)paramValue);
+}
+
+AlgoritmParameterValue caRandom::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "seed") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
 
 	return seed_;
 }
 
+
+void caSampledLRU::setPageCount(PageCount pageCount)
+{
+	caRandom::setPageCount(pageCount);
+	accessTime_.assign(pageCount, 0);
+	freeSlots_.clear();
+	nextFree_ = 0;
+	clock_ = 0;
+}
+
+void caSampledLRU::reset()
+{
+	setPageCount(pageCount_);
+}
+
+void caSampledLRU::touch(SlotIndex slot)
+{
+	if (++clock_ == 0)
+	{
+		clock_ = 1;
+	}
+	accessTime_[slot] = clock_;
+}
+
+void caSampledLRU::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+	case PAGE_REPLACE:
+		touch(page);
+		break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		if (accessTime_[page] != 0)
+		{
+			accessTime_[page] = 0;
+			freeSlots_.push_back(page);
+		}
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber caSampledLRU::getReplacePage()
+{
+	while (!freeSlots_.empty())
+	{
+		if (accessTime_[freeSlots_.back()] == 0)
+		{
+			return freeSlots_.back();
+		}
+		freeSlots_.pop_back();
+	}
+
+	while (nextFree_ < pageCount_ && accessTime_[nextFree_] != 0)
+	{
+		nextFree_++;
+	}
+
+	if (nextFree_ < pageCount_)
+	{
+		return nextFree_;
+	}
+
+	return sampleVictim(generator_);
+}
+
+PageNumber caSampledLRU::sampleVictim(std::mt19937& generator) const
+{
+	//The age is computed modulo the range of the access time, so the wrap around of the clock does not matter
+	std::uniform_int_distribution<PageNumber> numbers(0, pageCount_ - 1);
+	PageNumber victim = numbers(generator);
+	AccessTime victimAge = clock_ - accessTime_[victim];
+
+	for (size_t i = 1; i < samples_; i++)
+	{
+		PageNumber slot = numbers(generator);
+		AccessTime age = clock_ - accessTime_[slot];
+
+		if (age > victimAge)
+		{
+			victim = slot;
+			victimAge = age;
+		}
+	}
+
+	return victim;
+}
+
+void caSampledLRU::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	if (pageCount_ == 0)
+	{
+		return;
+	}
+
+	//The free slots in the order of getReplacePage: the slots freed by reset, then the slots that were never used
+	for (size_t i = freeSlots_.size(); i > 0 && candidates.size() < maxCount; i--)
+	{
+		if (accessTime_[freeSlots_[i - 1]] == 0 && std::find(candidates.begin(), candidates.end(), freeSlots_[i - 1]) == candidates.end())
+		{
+			candidates.push_back(freeSlots_[i - 1]);
+		}
+	}
+
+	for (SlotIndex slot = nextFree_; slot < pageCount_ && candidates.size() < maxCount; slot++)
+	{
+		if (accessTime_[slot] == 0 && std::find(candidates.begin(), candidates.end(), slot) == candidates.end())
+		{
+			candidates.push_back(slot);
+		}
+	}
+
+	//Every next candidate is the oldest page of a new sample. The samples are drawn by a copy of the generator,
+	//so the first one is the victim that getReplacePage takes next
+	std::mt19937 generator = generator_;
+	for (size_t attempt = 0; attempt < 2 * maxCount && candidates.size() < maxCount; attempt++)
+	{
+		PageNumber slot = sampleVictim(generator);
+		if (std::find(candidates.begin(), candidates.end(), slot) == candidates.end())
+		{
+			candidates.push_back(slot);
+		}
+	}
+}
+
+void caSampledLRU::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "samples") != 0)
+	{
+		caRandom::setParameter(paramName, paramValue);
+		return;
+	}
+
+	if (paramValue < 1)
+	{
+		throw cache_exception(ERR_PARAMETER_VALUE);
+	}
+
+	samples_ = (size_t)paramValue;
+}
+
+AlgoritmParameterValue caSampledLRU::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "samples") != 0)
+	{
+		return caRandom::getParameter(paramName);
+	}
+
+	return (AlgoritmParameterValue)samples_;
+}
+
+
+void GhostQueue::push(PageNumber page)
+{
+	if (page == INVALID_PAGE || contains(page))
+	{
+		return;
+	}
+
+	queue_.push_back(page);
+	locator_[page] = std::prev(queue_.end());
+}
+
+bool GhostQueue::remove(PageNumber page)
+{
+	auto found = locator_.find(page);
+	if (found == locator_.end())
+	{
+		return false;
+	}
+
+	queue_.erase(found->second);
+	locator_.erase(found);
+	return true;
+}
+
+bool GhostQueue::contains(PageNumber page) const
+{
+	return locator_.find(page) != locator_.end();
+}
+
+void GhostQueue::popOldest()
+{
+	if (!queue_.empty())
+	{
+		locator_.erase(queue_.front());
+		queue_.pop_front();
+	}
+}
+
+size_t GhostQueue::size() const
+{
+	return queue_.size();
+}
+
+void GhostQueue::clear()
+{
+	queue_.clear();
+	locator_.clear();
+}
+
+void FrequencySketch::setSize(size_t pageCount)
+{
+	width_ = 16;
+	while (width_ < pageCount)
+	{
+		width_ <<= 1;
+	}
+
+	table_.assign(width_ * SKETCH_DEPTH / 16, 0);
+	sampleSize_ = 10 * std::max<size_t>(pageCount, 1);
+	sampleCount_ = 0;
+}
+
+void FrequencySketch::clear()
+{
+	std::fill(table_.begin(), table_.end(), 0);
+	sampleCount_ = 0;
+}
+
+size_t FrequencySketch::getCounterIndex(PageNumber page, unsigned int row) const
+{
+	static const uint64_t seeds[SKETCH_DEPTH] = 
+	{ 
+		0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull 
+	};
+
+	uint64_t hash = ((uint64_t)page + 1) * seeds[row];
+	hash ^= hash >> 32;
+	return row * width_ + (size_t)(hash & (width_ - 1));
+}
+
+unsigned int FrequencySketch::getCounter(size_t index) const
+{
+	return (unsigned int)(table_[index >> 4] >> ((index & 15) << 2)) & COUNTER_MAX;
+}
+
+void FrequencySketch::increment(PageNumber page)
+{
+	if (table_.empty())
+	{
+		return;
+	}
+
+	for (unsigned int row = 0; row < SKETCH_DEPTH; row++)
+	{
+		size_t index = getCounterIndex(page, row);
+		if (getCounter(index) < COUNTER_MAX)
+		{
+			table_[index >> 4] += (uint64_t)1 << ((index & 15) << 2);
+		}
+	}
+
+	if (++sampleCount_ >= sampleSize_)
+	{
+		halve();
+	}
+}
+
+unsigned int FrequencySketch::estimate(PageNumber page) const
+{
+	if (table_.empty())
+	{
+		return 0;
+	}
+
+	unsigned int frequency = COUNTER_MAX;
+	for (unsigned int row = 0; row < SKETCH_DEPTH; row++)
+	{
+		frequency = std::min(frequency, getCounter(getCounterIndex(page, row)));
+	}
+	return frequency;
+}
+
+void FrequencySketch::halve()
+{
+	for (auto& word : table_)
+	{
+		word = (word >> 1) & 0x7777777777777777ull;
+	}
+	sampleCount_ /= 2;
+}
+
+CacheAlgorithmLists::CacheAlgorithmLists(unsigned int listCount) : lists_(listCount)
+{
+
+}
+
+void CacheAlgorithmLists::setPageCount(PageCount pageCount)
+{
+	for (auto& list : lists_)
+	{
+		list.clear();
+	}
+
+	slots_.clear();
+	slots_.resize(pageCount);
+
+	SlotList& freeList = lists_[LIST_FREE];
+	for (SlotIndex slot = 0; slot < pageCount; slot++)
+	{
+		slots_[slot].list = LIST_FREE;
+		slots_[slot].locator = freeList.insert(freeList.end(), slot);
+		slots_[slot].page = INVALID_PAGE;
+		slots_[slot].isFirstAccess = false;
+	}
+}
+
+void CacheAlgorithmLists::reset()
+{
+	setPageCount(slots_.size());
+}
+
+void CacheAlgorithmLists::moveSlot(SlotIndex slot, unsigned int list)
+{
+	SlotEntry& entry = slots_[slot];
+	SlotList& target = lists_[list];
+	target.splice(target.end(), lists_[entry.list], entry.locator);
+	entry.list = list;
+}
+
+void CacheAlgorithmLists::freeSlot(SlotIndex slot)
+{
+	SlotEntry& entry = slots_[slot];
+	SlotList& freeList = lists_[LIST_FREE];
+	freeList.splice(freeList.begin(), lists_[entry.list], entry.locator);
+	entry.list = LIST_FREE;
+	entry.page = INVALID_PAGE;
+	entry.isFirstAccess = false;
+}
+
+bool CacheAlgorithmLists::isReplaceAccess(SlotIndex slot)
+{
+	//The controller reports an access right after PAGE_REPLACE, it belongs to the same reference
+	bool isFirstAccess = slots_[slot].isFirstAccess;
+	slots_[slot].isFirstAccess = false;
+	return isFirstAccess;
+}
+
+PageCount CacheAlgorithmLists::getPageCount() const
+{
+	return slots_.size();
+}
+
+void CacheAlgorithmLists::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	if (maxCount == 0 || slots_.empty())
+	{
+		return;
+	}
+
+	//The victim goes first if the algorithm can tell it, the rest are the free slots and then the candidates
+	//of the lists from their oldest pages. The algorithm state does not change
+	SlotIndex victim = peekReplacePage();
+	if (victim != INVALID_SLOT)
+	{
+		candidates.push_back(victim);
+	}
+
+	for (SlotList& list : lists_)
+	{
+		for (SlotList::iterator item = list.begin(); item != list.end() && candidates.size() < maxCount; item++)
+		{
+			if (*item != victim && isCandidate(*item))
+			{
+				candidates.push_back(*item);
+			}
+		}
+	}
+}
+
+SlotIndex CacheAlgorithmLists::peekReplacePage() const
+{
+	return INVALID_SLOT;
+}
+
+bool CacheAlgorithmLists::isCandidate(SlotIndex) const
+{
+	return true;
+}
+
+caARC::caARC() : CacheAlgorithmLists(3)
+{
+
+}
+
+void caARC::setPageCount(PageCount pageCount)
+{
+	CacheAlgorithmLists::setPageCount(pageCount);
+	b1_.clear();
+	b2_.clear();
+	targetT1_ = 0;
+}
+
+void caARC::trimGhosts()
+{
+	const size_t pageCount = getPageCount();
+	const SlotList& t1 = lists_[LIST_T1];
+	const SlotList& t2 = lists_[LIST_T2];
+
+	while (t1.size() + b1_.size() > pageCount && b1_.size() > 0)
+	{
+		b1_.popOldest();
+	}
+
+	while (t1.size() + t2.size() + b1_.size() + b2_.size() > 2 * pageCount)
+	{
+		if (b2_.size() > 0)
+		{
+			b2_.popOldest();
+		}
+		else
+		{
+			b1_.popOldest();
+		}
+	}
+}
+
+void caARC::retainGhost(SlotIndex slot)
+{
+	const SlotEntry& entry = slots_[slot];
+
+	if (entry.list == LIST_T1)
+	{
+		b1_.push(entry.page);
+	}
+	else if (entry.list == LIST_T2)
+	{
+		b2_.push(entry.page);
+	}
+}
+
+void caARC::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (!isReplaceAccess(page) && entry.list != LIST_FREE)
+		{
+			moveSlot(page, LIST_T2);
+		}
+		break;
+
+	case PAGE_REPLACE:
+	{
+		retainGhost(page);
+
+		if (b1_.remove(storagePage))
+		{
+			size_t delta = std::max<size_t>(1, b2_.size() / (b1_.size() + 1));
+			targetT1_ = std::min(targetT1_ + delta, getPageCount());
+			moveSlot(page, LIST_T2);
+		}
+		else if (b2_.remove(storagePage))
+		{
+			size_t delta = std::max<size_t>(1, b1_.size() / (b2_.size() + 1));
+			targetT1_ = targetT1_ > delta ? targetT1_ - delta : 0;
+			moveSlot(page, LIST_T2);
+		}
+		else
+		{
+			moveSlot(page, LIST_T1);
+		}
+
+		entry.page = storagePage;
+		entry.isFirstAccess = true;
+
+		trimGhosts();
+	}
+	break;
+
+	case PAGE_EVICT:
+		retainGhost(page);
+		freeSlot(page);
+		trimGhosts();
+		break;
+
+	case PAGE_RESET:
+		freeSlot(page);
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber caARC::getReplacePage()
+{
+	return peekReplacePage();
+}
+
+SlotIndex caARC::peekReplacePage() const
+{
+	const SlotList& t1 = lists_[LIST_T1];
+	const SlotList& t2 = lists_[LIST_T2];
+
+	if (!lists_[LIST_FREE].empty())
+	{
+		return lists_[LIST_FREE].front();
+	}
+
+	if (!t1.empty() && (t1.size() > targetT1_ || t2.empty()))
+	{
+		return t1.front();
+	}
+
+	return t2.front();
+}
+
+AlgoritmParameterValue caARC::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "p") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	return (AlgoritmParameterValue)targetT1_;
+}
+
+ca2Q::ca2Q() : CacheAlgorithmLists(3)
+{
+
+}
+
+void ca2Q::setPageCount(PageCount pageCount)
+{
+	CacheAlgorithmLists::setPageCount(pageCount);
+	a1out_.clear();
+}
+
+size_t ca2Q::getSizeIn() const
+{
+	return std::max<size_t>(1, (size_t)(getPageCount() * ratioIn_));
+}
+
+size_t ca2Q::getSizeOut() const
+{
+	return std::max<size_t>(1, (size_t)(getPageCount() * ratioOut_));
+}
+
+void ca2Q::trimGhosts()
+{
+	while (a1out_.size() > getSizeOut())
+	{
+		a1out_.popOldest();
+	}
+}
+
+void ca2Q::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		//Pages in A1in are not moved: repeated accesses within the probation period are correlated
+		if (!isReplaceAccess(page) && entry.list == LIST_AM)
+		{
+			moveSlot(page, LIST_AM);
+		}
+		break;
+
+	case PAGE_REPLACE:
+		if (entry.list == LIST_A1IN)
+		{
+			a1out_.push(entry.page);
+			trimGhosts();
+		}
+
+		if (a1out_.remove(storagePage))
+		{
+			moveSlot(page, LIST_AM);
+		}
+		else
+		{
+			moveSlot(page, LIST_A1IN);
+		}
+
+		entry.page = storagePage;
+		entry.isFirstAccess = true;
+		break;
+
+	case PAGE_EVICT:
+		if (entry.list == LIST_A1IN)
+		{
+			a1out_.push(entry.page);
+			trimGhosts();
+		}
+		freeSlot(page);
+		break;
+
+	case PAGE_RESET:
+		freeSlot(page);
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber ca2Q::getReplacePage()
+{
+	return peekReplacePage();
+}
+
+SlotIndex ca2Q::peekReplacePage() const
+{
+	const SlotList& a1in = lists_[LIST_A1IN];
+	const SlotList& am = lists_[LIST_AM];
+
+	if (!lists_[LIST_FREE].empty())
+	{
+		return lists_[LIST_FREE].front();
+	}
+
+	if (!a1in.empty() && (a1in.size() > getSizeIn() || am.empty()))
+	{
+		return a1in.front();
+	}
+
+	return am.front();
+}
+
+void ca2Q::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "kin") == 0)
+	{
+		if (paramValue <= 0 || paramValue >= 1)
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+		ratioIn_ = paramValue;
+	}
+	else if (::strcmp(paramName, "kout") == 0)
+	{
+		if (paramValue <= 0)
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+		ratioOut_ = paramValue;
+		trimGhosts();
+	}
+	else
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+}
+
+AlgoritmParameterValue ca2Q::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "kin") == 0)
+	{
+		return ratioIn_;
+	}
+	else if (::strcmp(paramName, "kout") == 0)
+	{
+		return ratioOut_;
+	}
+
+	throw cache_exception(ERR_PARAMETER_NAME);
+}
+
+caLIRS::caLIRS() : CacheAlgorithmLists(2)
+{
+
+}
+
+void caLIRS::setPageCount(PageCount pageCount)
+{
+	CacheAlgorithmLists::setPageCount(pageCount);
+	pages_.clear();
+	stack_.clear();
+	queue_.clear();
+	nonResident_.clear();
+	lirCount_ = 0;
+}
+
+size_t caLIRS::getLirLimit() const
+{
+	size_t hirCount = std::max<size_t>(1, (size_t)(getPageCount() * ratioHir_));
+	return getPageCount() > hirCount ? getPageCount() - hirCount : 0;
+}
+
+size_t caLIRS::getNonResidentLimit() const
+{
+	return (size_t)(getPageCount() * ratioNonResident_);
+}
+
+void caLIRS::pushStack(PageNumber storagePage, PageEntry& entry)
+{
+	if (entry.isInStack)
+	{
+		stack_.splice(stack_.end(), stack_, entry.stackLocator);
+	}
+	else
+	{
+		entry.stackLocator = stack_.insert(stack_.end(), storagePage);
+		entry.isInStack = true;
+	}
+}
+
+void caLIRS::pushQueue(PageNumber storagePage, PageEntry& entry)
+{
+	if (entry.isInQueue)
+	{
+		queue_.splice(queue_.end(), queue_, entry.queueLocator);
+	}
+	else
+	{
+		entry.queueLocator = queue_.insert(queue_.end(), storagePage);
+		entry.isInQueue = true;
+	}
+}
+
+void caLIRS::removeQueue(PageEntry& entry)
+{
+	if (entry.isInQueue)
+	{
+		queue_.erase(entry.queueLocator);
+		entry.isInQueue = false;
+	}
+}
+
+void caLIRS::erasePage(PageTable::iterator item)
+{
+	PageEntry& entry = item->second;
+
+	if (entry.isInStack)
+	{
+		stack_.erase(entry.stackLocator);
+	}
+	if (entry.state == PAGE_HIR_NONRESIDENT)
+	{
+		nonResident_.erase(entry.nonResidentLocator);
+	}
+	if (entry.state == PAGE_LIR)
+	{
+		lirCount_--;
+	}
+	removeQueue(entry);
+
+	pages_.erase(item);
+}
+
+void caLIRS::pruneStack()
+{
+	//The bottom of the stack must always be a LIR page
+	while (!stack_.empty())
+	{
+		PageTable::iterator item = pages_.find(stack_.front());
+		PageEntry& entry = item->second;
+
+		if (entry.state == PAGE_LIR)
+		{
+			break;
+		}
+
+		if (entry.state == PAGE_HIR_NONRESIDENT)
+		{
+			erasePage(item);
+		}
+		else
+		{
+			stack_.pop_front();
+			entry.isInStack = false;
+		}
+	}
+}
+
+void caLIRS::demoteBottomLir()
+{
+	PageNumber bottomPage = stack_.front();
+	PageEntry& entry = pages_[bottomPage];
+
+	stack_.pop_front();
+	entry.isInStack = false;
+	entry.state = PAGE_HIR_RESIDENT;
+	lirCount_--;
+	pushQueue(bottomPage, entry);
+
+	pruneStack();
+}
+
+void caLIRS::trimNonResident()
+{
+	while (nonResident_.size() > getNonResidentLimit())
+	{
+		erasePage(pages_.find(nonResident_.front()));
+	}
+}
+
+void caLIRS::accessPage(PageNumber storagePage)
+{
+	PageTable::iterator item = pages_.find(storagePage);
+	if (item == pages_.end())
+	{
+		return;
+	}
+
+	PageEntry& entry = item->second;
+
+	if (entry.state == PAGE_LIR)
+	{
+		bool isBottom = stack_.front() == storagePage;
+		pushStack(storagePage, entry);
+		if (isBottom)
+		{
+			pruneStack();
+		}
+	}
+	else if (entry.isInStack)
+	{
+		//The inter-reference recency of the page is less than the recency of the bottom LIR page
+		entry.state = PAGE_LIR;
+		lirCount_++;
+		removeQueue(entry);
+		pushStack(storagePage, entry);
+		demoteBottomLir();
+	}
+	else
+	{
+		pushStack(storagePage, entry);
+		pushQueue(storagePage, entry);
+	}
+}
+
+void caLIRS::evictPage(PageNumber storagePage)
+{
+	PageTable::iterator item = pages_.find(storagePage);
+	if (item == pages_.end())
+	{
+		return;
+	}
+
+	PageEntry& entry = item->second;
+
+	if (!entry.isInStack)
+	{
+		erasePage(item);
+		return;
+	}
+
+	if (entry.state == PAGE_LIR)
+	{
+		lirCount_--;
+	}
+
+	removeQueue(entry);
+	entry.state = PAGE_HIR_NONRESIDENT;
+	entry.slot = INVALID_SLOT;
+	entry.nonResidentLocator = nonResident_.insert(nonResident_.end(), storagePage);
+
+	pruneStack();
+	trimNonResident();
+}
+
+void caLIRS::loadPage(SlotIndex slot, PageNumber storagePage)
+{
+	PageTable::iterator item = pages_.find(storagePage);
+
+	if (item != pages_.end() && item->second.state != PAGE_HIR_NONRESIDENT)
+	{
+		erasePage(item);
+		pruneStack();
+		item = pages_.end();
+	}
+
+	if (item != pages_.end())
+	{
+		//The page is found in the stack as a non-resident HIR page
+		PageEntry& entry = item->second;
+		nonResident_.erase(entry.nonResidentLocator);
+		entry.slot = slot;
+		entry.state = PAGE_LIR;
+		lirCount_++;
+		pushStack(storagePage, entry);
+
+		if (lirCount_ > getLirLimit())
+		{
+			demoteBottomLir();
+		}
+		return;
+	}
+
+	PageEntry& entry = pages_[storagePage];
+	entry.slot = slot;
+	entry.isInStack = false;
+	entry.isInQueue = false;
+
+	pushStack(storagePage, entry);
+
+	if (lirCount_ < getLirLimit())
+	{
+		entry.state = PAGE_LIR;
+		lirCount_++;
+	}
+	else
+	{
+		entry.state = PAGE_HIR_RESIDENT;
+		pushQueue(storagePage, entry);
+		pruneStack();
+	}
+}
+
+void caLIRS::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& slot = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (!isReplaceAccess(page) && slot.list != LIST_FREE)
+		{
+			accessPage(slot.page);
+		}
+		break;
+
+	case PAGE_REPLACE:
+		if (slot.list != LIST_FREE)
+		{
+			evictPage(slot.page);
+		}
+
+		moveSlot(page, LIST_USED);
+		slot.page = storagePage;
+		slot.isFirstAccess = true;
+
+		if (storagePage != INVALID_PAGE)
+		{
+			loadPage(page, storagePage);
+		}
+		break;
+
+	case PAGE_EVICT:
+		if (slot.list != LIST_FREE)
+		{
+			evictPage(slot.page);
+		}
+		freeSlot(page);
+		break;
+
+	case PAGE_RESET:
+		if (slot.list != LIST_FREE)
+		{
+			PageTable::iterator item = pages_.find(slot.page);
+			if (item != pages_.end())
+			{
+				erasePage(item);
+				pruneStack();
+			}
+		}
+		freeSlot(page);
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber caLIRS::getReplacePage()
+{
+	if (!lists_[LIST_FREE].empty())
+	{
+		return lists_[LIST_FREE].front();
+	}
+
+	if (!queue_.empty())
+	{
+		return pages_[queue_.front()].slot;
+	}
+
+	if (!stack_.empty())
+	{
+		return pages_[stack_.front()].slot;
+	}
+
+	return lists_[LIST_USED].front();
+}
+
+void caLIRS::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	//The free slots, then the resident HIR pages from the front of the queue; a LIR page is not evicted before it is demoted
+	for (SlotList::iterator item = lists_[LIST_FREE].begin(); item != lists_[LIST_FREE].end() && candidates.size() < maxCount; item++)
+	{
+		candidates.push_back(*item);
+	}
+
+	for (PageStack::iterator item = queue_.begin(); item != queue_.end() && candidates.size() < maxCount; item++)
+	{
+		candidates.push_back(pages_.find(*item)->second.slot);
+	}
+}
+
+void caLIRS::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "hir") == 0)
+	{
+		if (paramValue <= 0 || paramValue >= 1)
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+		ratioHir_ = paramValue;
+	}
+	else if (::strcmp(paramName, "nonresident") == 0)
+	{
+		if (paramValue < 0)
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+		ratioNonResident_ = paramValue;
+		trimNonResident();
+	}
+	else
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+}
+
+AlgoritmParameterValue caLIRS::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "hir") == 0)
+	{
+		return ratioHir_;
+	}
+	else if (::strcmp(paramName, "nonresident") == 0)
+	{
+		return ratioNonResident_;
+	}
+
+	throw cache_exception(ERR_PARAMETER_NAME);
+}
+
+caTinyLFU::caTinyLFU() : CacheAlgorithmLists(4)
+{
+
+}
+
+void caTinyLFU::setPageCount(PageCount pageCount)
+{
+	CacheAlgorithmLists::setPageCount(pageCount);
+	sketch_.setSize(pageCount);
+}
+
+size_t caTinyLFU::getWindowSize() const
+{
+	return std::max<size_t>(1, (size_t)(getPageCount() * ratioWindow_));
+}
+
+size_t caTinyLFU::getProtectedSize() const
+{
+	size_t mainSize = getPageCount() > getWindowSize() ? getPageCount() - getWindowSize() : 0;
+	return std::max<size_t>(1, (size_t)(mainSize * ratioProtected_));
+}
+
+SlotIndex caTinyLFU::getMainVictim() const
+{
+	if (!lists_[LIST_PROBATION].empty())
+	{
+		return lists_[LIST_PROBATION].front();
+	}
+
+	if (!lists_[LIST_PROTECTED].empty())
+	{
+		return lists_[LIST_PROTECTED].front();
+	}
+
+	return INVALID_SLOT;
+}
+
+void caTinyLFU::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (isReplaceAccess(page) || entry.list == LIST_FREE)
+		{
+			break;
+		}
+
+		sketch_.increment(entry.page);
+
+		if (entry.list == LIST_PROBATION || entry.list == LIST_PROTECTED)
+		{
+			moveSlot(page, LIST_PROTECTED);
+
+			if (lists_[LIST_PROTECTED].size() > getProtectedSize())
+			{
+				moveSlot(lists_[LIST_PROTECTED].front(), LIST_PROBATION);
+			}
+		}
+		else
+		{
+			moveSlot(page, LIST_WINDOW);
+		}
+		break;
+
+	case PAGE_REPLACE:
+	{
+		sketch_.increment(storagePage);
+
+		//If the victim was taken from the main part, the oldest window page has won the admission
+		bool isWindowVictim = entry.list == LIST_WINDOW;
+
+		moveSlot(page, LIST_WINDOW);
+		entry.page = storagePage;
+		entry.isFirstAccess = true;
+
+		if (!isWindowVictim && lists_[LIST_WINDOW].size() > getWindowSize())
+		{
+			moveSlot(lists_[LIST_WINDOW].front(), LIST_PROBATION);
+		}
+	}
+	break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		freeSlot(page);
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber caTinyLFU::getReplacePage()
+{
+	return peekReplacePage();
+}
+
+SlotIndex caTinyLFU::peekReplacePage() const
+{
+	if (!lists_[LIST_FREE].empty())
+	{
+		return lists_[LIST_FREE].front();
+	}
+
+	const SlotList& window = lists_[LIST_WINDOW];
+	SlotIndex mainVictim = getMainVictim();
+
+	if (mainVictim == INVALID_SLOT)
+	{
+		return window.front();
+	}
+
+	if (window.size() < getWindowSize() || window.empty())
+	{
+		return mainVictim;
+	}
+
+	SlotIndex candidate = window.front();
+
+	//Admission: the window candidate replaces the main victim only if it is accessed more frequently
+	if (sketch_.estimate(slots_[candidate].page) > sketch_.estimate(slots_[mainVictim].page))
+	{
+		return mainVictim;
+	}
+
+	return candidate;
+}
+
+void caTinyLFU::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	AlgoritmParameterValue* ratio = nullptr;
+
+	if (::strcmp(paramName, "window") == 0)
+	{
+		ratio = &ratioWindow_;
+	}
+	else if (::strcmp(paramName, "protected") == 0)
+	{
+		ratio = &ratioProtected_;
+	}
+	else
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	if (paramValue <= 0 || paramValue >= 1)
+	{
+		throw cache_exception(ERR_PARAMETER_VALUE);
+	}
+
+	*ratio = paramValue;
+}
+
+AlgoritmParameterValue caTinyLFU::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "window") == 0)
+	{
+		return ratioWindow_;
+	}
+	else if (::strcmp(paramName, "protected") == 0)
+	{
+		return ratioProtected_;
+	}
+
+	throw cache_exception(ERR_PARAMETER_NAME);
+}
+
+caSieve::caSieve() : CacheAlgorithmLists(2)
+{
+
+}
+
+void caSieve::setPageCount(PageCount pageCount)
+{
+	CacheAlgorithmLists::setPageCount(pageCount);
+	isVisited_.assign(pageCount, false);
+	hand_ = lists_[LIST_QUEUE].end();
+}
+
+void caSieve::moveHand(SlotIndex slot)
+{
+	//The slot leaves its position in the queue, the hand goes on to the next newer page
+	if (hand_ != lists_[LIST_QUEUE].end() && *hand_ == slot)
+	{
+		hand_++;
+	}
+}
+
+void caSieve::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (!isReplaceAccess(page) && slots_[page].list != LIST_FREE)
+		{
+			isVisited_[page] = true;
+		}
+		break;
+
+	case PAGE_REPLACE:
+		moveHand(page);
+		moveSlot(page, LIST_QUEUE);
+		slots_[page].page = storagePage;
+		slots_[page].isFirstAccess = true;
+		isVisited_[page] = false;
+		break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		moveHand(page);
+		freeSlot(page);
+		isVisited_[page] = false;
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+PageNumber caSieve::getReplacePage()
+{
+	if (!lists_[LIST_FREE].empty())
+	{
+		return lists_[LIST_FREE].front();
+	}
+
+	SlotList& queue = lists_[LIST_QUEUE];
+
+	//There is an unvisited page at least after the second pass
+	for (size_t step = 0; step <= 2 * queue.size(); step++)
+	{
+		if (hand_ == queue.end())
+		{
+			hand_ = queue.begin();
+		}
+
+		if (!isVisited_[*hand_])
+		{
+			break;
+		}
+
+		isVisited_[*hand_] = false;
+		hand_++;
+	}
+
+	return *hand_;
+}
+
+void caSieve::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount)
+{
+	candidates.clear();
+
+	//The free slots, then the pages that are not visited in the order the hand meets them; the hand does not move
+	for (SlotList::iterator item = lists_[LIST_FREE].begin(); item != lists_[LIST_FREE].end() && candidates.size() < maxCount; item++)
+	{
+		candidates.push_back(*item);
+	}
+
+	SlotList& queue = lists_[LIST_QUEUE];
+	SlotList::iterator hand = hand_;
+	for (size_t step = 0; step < queue.size() && candidates.size() < maxCount; step++, hand++)
+	{
+		if (hand == queue.end())
+		{
+			hand = queue.begin();
+		}
+
+		if (!isVisited_[*hand])
+		{
+			candidates.push_back(*hand);
+		}
+	}
+}
+
+caS3FIFO::caS3FIFO() : CacheAlgorithmLists(3)
+{
+
+}
+
+void caS3FIFO::setPageCount(PageCount pageCount)
+{
+	CacheAlgorithmLists::setPageCount(pageCount);
+	ghost_.clear();
+	frequency_.assign(pageCount, 0);
+}
+
+size_t caS3FIFO::getSmallSize() const
+{
+	return std::max<size_t>(1, (size_t)(getPageCount() * ratioSmall_));
+}
+
+void caS3FIFO::retainGhost(SlotIndex slot)
+{
+	const SlotEntry& entry = slots_[slot];
+
+	if (entry.list == LIST_SMALL)
+	{
+		ghost_.push(entry.page);
+		while (ghost_.size() > getPageCount() - getSmallSize())
+		{
+			ghost_.popOldest();
+		}
+	}
+}
+
+void caS3FIFO::onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage)
+{
+	SlotEntry& entry = slots_[page];
+
+	switch (pageOperation)
+	{
+	case PAGE_READ:
+	case PAGE_WRITE:
+		if (!isReplaceAccess(page) && entry.list != LIST_FREE && frequency_[page] < FREQUENCY_MAX)
+		{
+			frequency_[page]++;
+		}
+		break;
+
+	case PAGE_REPLACE:
+		retainGhost(page);
+
+		moveSlot(page, ghost_.remove(storagePage) ? LIST_MAIN : LIST_SMALL);
+		entry.page = storagePage;
+		entry.isFirstAccess = true;
+		frequency_[page] = 0;
+		break;
+
+	case PAGE_RESET:
+	case PAGE_EVICT:
+		if (pageOperation == PAGE_EVICT)
+		{
+			retainGhost(page);
+		}
+		freeSlot(page);
+		frequency_[page] = 0;
+		break;
+
+	case PAGE_FLUSH:
+		break;
+	}
+}
+
+bool caS3FIFO::isCandidate(SlotIndex slot) const
+{
+	//A page accessed again goes to the main queue or back to its tail before it can be evicted
+	return slots_[slot].list == LIST_FREE || frequency_[slot] == 0;
+}
+
+PageNumber caS3FIFO::getReplacePage()
+{
+	if (!lists_[LIST_FREE].empty())
+	{
+		return lists_[LIST_FREE].front();
+	}
+
+	SlotList& small = lists_[LIST_SMALL];
+	SlotList& main = lists_[LIST_MAIN];
+
+	//Every step either returns the victim or decrements a frequency, so the loop is finite
+	while (true)
+	{
+		if (!small.empty() && (small.size() >= getSmallSize() || main.empty()))
+		{
+			SlotIndex slot = small.front();
+			if (frequency_[slot] == 0)
+			{
+				return slot;
+			}
+
+			//The page was accessed again while it was in the small queue
+			frequency_[slot] = 0;
+			moveSlot(slot, LIST_MAIN);
+		}
+		else
+		{
+			SlotIndex slot = main.front();
+			if (frequency_[slot] == 0)
+			{
+				return slot;
+			}
+
+			frequency_[slot]--;
+			moveSlot(slot, LIST_MAIN);
+		}
+	}
+}
+
+void caS3FIFO::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
+{
+	if (::strcmp(paramName, "small") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	if (paramValue <= 0 || paramValue >= 1)
+	{
+		throw cache_exception(ERR_PARAMETER_VALUE);
+	}
+
+	ratioSmall_ = paramValue;
+}
+
+AlgoritmParameterValue caS3FIFO::getParameter(const char* paramName) const
+{
+	if (::strcmp(paramName, "small") != 0)
+	{
+		throw cache_exception(ERR_PARAMETER_NAME);
+	}
+
+	return ratioSmall_;
+}
\ No newline at end of file
@@ -3,11 +3,13 @@
 #include "CacheAlgorithm.h"
 
 #include <vector>
+#include <algorithm>
 #include <list>
+#include <set>
+#include <tuple>
+#include <unordered_map>
 #include <random>
-#include <thread>
-#include <condition_variable>
-#include <mutex>
+#include <chrono>
 
 namespace cache
 {
@@ -18,6 +20,7 @@ namespace cache
 	public:
 		void setPageCount(PageCount pageCount) override;
 		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
 		void reset() override;
 		virtual void getPageQueue(std::vector<PageNumber>& queue) const;
 
@@ -33,28 +36,86 @@ namespace cache
 	class caFIFO : public CacheAlgorithmQueue
 	{
 	public:
-		 void onPageOperation(PageNumber page, PageOperation pageOperation) override;
+		 void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
 	};
 
 	//Least recently used 
 	class caLRU : public CacheAlgorithmQueue
 	{
 	public:
-		 void onPageOperation(PageNumber page, PageOperation pageOperation) override;
+		 void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
 	};
 
-	//Least Frequently Used 
-	class caLFU : public CacheAlgorithmQueue
+	//Least Frequently Used: slots are kept in the buckets of equal frequency, the frequencies are aged periodically
+	class caLFU : public CacheAlgorithm
 	{
 	public:
-		 void onPageOperation(PageNumber page, PageOperation pageOperation) override;
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+		void reset() override;
+		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		typedef std::list<SlotIndex> SlotList;
+
+		struct Bucket
+		{
+			unsigned long frequency;
+			SlotList slots;
+		};
+
+		typedef std::list<Bucket> BucketList;
+
+		struct SlotEntry
+		{
+			bool isFree;
+			bool isFirstAccess;
+			BucketList::iterator bucket;
+			SlotList::iterator locator;
+		};
+
+		void moveToBucket(SlotIndex slot, unsigned long frequency);
+		void removeFromBucket(SlotIndex slot);
+		void age();
+
+		BucketList buckets_;		//in the ascending order of frequency
+		SlotList freeSlots_;
+		std::vector<SlotEntry> slots_;
+		size_t accessCount_ = 0;
+		AlgoritmParameterValue decay_ = 0.5;
 	};
 
 	//Most Recently Used 
 	class caMRU : public CacheAlgorithmQueue
 	{
 	public:
-		 void onPageOperation(PageNumber page, PageOperation pageOperation) override;
+		 void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+	};
+
+	//Bitmap of the reference bits; the summary bitmap marks the words with all bits set, so they are skipped at once
+	class ReferenceBitmap
+	{
+	public:
+		void resize(size_t size);
+		size_t size() const;
+		bool test(size_t index) const;
+		void set(size_t index);
+
+		//Clears the set bits from the beginning of the range up to the first clear bit, returns its index or end
+		size_t sweep(size_t begin, size_t end);
+
+	private:
+		typedef uint64_t Word;
+		static const size_t WORD_BITS = 64;
+
+		size_t findNotFullWord(size_t word, size_t endWord) const;
+
+		std::vector<Word> words_;
+		std::vector<Word> summary_;
+		size_t size_ = 0;
 	};
 
 	class caClock: public CacheAlgorithm
@@ -62,49 +123,195 @@ namespace cache
 	public:
 		void setPageCount(PageCount pageCount) override;
 		PageNumber getReplacePage() override;
-		void onPageOperation(PageNumber page, PageOperation pageOperation) override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
 		void reset() override;
 
 	private:
-		std::vector<bool> listPages_;
+		ReferenceBitmap listPages_;
 		size_t currentPage_ = 0;
 	};
 
+	//CLOCK-Pro: hot, cold and non-resident cold (test) pages on one clock
+	class caClockPro : public CacheAlgorithm
+	{
+	public:
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+		void reset() override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		enum PageType
+		{
+			PAGE_HOT = 0,
+			PAGE_COLD = 1,
+			PAGE_TEST = 2
+		};
+
+		struct ClockEntry
+		{
+			PageNumber page;
+			SlotIndex slot;
+			PageType type;
+			bool isReferenced;
+			bool isInTest;
+		};
+
+		typedef std::list<ClockEntry> Clock;
+		typedef Clock::iterator ClockHand;
+
+		struct SlotEntry
+		{
+			bool isFree;
+			bool isFirstAccess;
+			ClockHand entry;
+			std::list<SlotIndex>::iterator freeLocator;
+		};
+
+		ClockHand getNext(ClockHand hand);
+		void insertEntry(PageNumber page, SlotIndex slot, PageType type);
+		void removeEntry(ClockHand entry);
+		void evictEntry(ClockHand entry);
+		void setType(ClockEntry& entry, PageType type);
+		void runHandHot();
+		void runHandTest();
+		void terminateTest(ClockHand entry);
+
+		Clock clock_;
+		ClockHand handHot_;
+		ClockHand handCold_;
+		ClockHand handTest_;
+		std::unordered_map<PageNumber, ClockHand> pages_;
+		std::vector<SlotEntry> slots_;
+		std::list<SlotIndex> freeSlots_;
+		size_t count_[3] = { 0, 0, 0 };
+		size_t coldTarget_ = 0;
+	};
+
+	//GreedyDual: evicts the page with the lowest priority, the priority of a page is its reloading cost plus the inflation value
+	class caGreedyDual : public CacheAlgorithm
+	{
+	public:
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		void onPageCost(PageNumber page, AlgoritmParameterValue cost) override;
+		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+		void reset() override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		typedef std::tuple<AlgoritmParameterValue, unsigned long long, SlotIndex> PriorityKey;
+		typedef std::set<PriorityKey> PriorityQueue;
+
+		struct SlotEntry
+		{
+			bool isFree;
+			bool isFirstAccess;
+			AlgoritmParameterValue cost;
+			PriorityQueue::iterator locator;
+		};
+
+		void setPriority(SlotIndex slot);
+
+		PriorityQueue queue_;		//the free slots have the lowest priority
+		std::vector<SlotEntry> slots_;
+		AlgoritmParameterValue inflation_ = 0;
+		AlgoritmParameterValue averageCost_ = 1;
+		unsigned long long sequence_ = 0;
+	};
+
+	//LRU-K: evicts the page with the oldest K-th most recent reference
+	class caLRUK : public CacheAlgorithm
+	{
+	public:
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+		void reset() override;
+		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		typedef unsigned long long ReferenceTime;
+		typedef std::tuple<ReferenceTime, ReferenceTime, SlotIndex> PriorityKey; //K-th and the last references
+		typedef std::set<PriorityKey> PriorityQueue;
+
+		struct PageHistory
+		{
+			std::vector<ReferenceTime> references;	//from the most recent one, 0 means no reference
+			ReferenceTime lastAccess;
+			bool isResident;
+			std::list<PageNumber>::iterator retainedLocator;
+		};
+
+		struct SlotEntry
+		{
+			bool isFree;
+			bool isFirstAccess;
+			PageNumber page;
+			PriorityQueue::iterator locator;
+		};
+
+		typedef std::unordered_map<PageNumber, PageHistory> HistoryTable;
+
+		enum
+		{
+			K_MAX = 16
+		};
+
+		void reference(PageHistory& history);
+		void setPriority(SlotIndex slot, const PageHistory& history);
+		void retainHistory(PageNumber page);
+		void trimHistory();
+
+		PriorityQueue queue_;
+		std::vector<SlotEntry> slots_;
+		HistoryTable history_;
+		std::list<PageNumber> retained_;	//history of the evicted pages, from the oldest one
+		ReferenceTime time_ = 0;
+		size_t k_ = 2;
+		ReferenceTime correlatedPeriod_ = 0;
+		AlgoritmParameterValue ratioRetained_ = 1;
+	};
+
 	//Not recently used
 	class caNRU : public CacheAlgorithm
 	{
 	public:
-		~caNRU();
 		void setPageCount(PageCount pageCount) override;
-		void onPageOperation(PageNumber page, PageOperation pageOperation) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
 		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
 		void reset() override;
 		void setTimerInterval(unsigned long intervalMillisec);
 		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
 		AlgoritmParameterValue getParameter(const char* paramName) const override;
 	private:
-		union UBits
-		{
-			UBits(char v) : value(v) {}
+		typedef unsigned long long Epoch;
 
-			struct
-			{
-				char referenced : 1;
-				char modified : 1;
-				char reserved : 6;
-			} bitValue;
+		//A page is referenced if it was accessed in the current epoch, so a new epoch clears all referenced bits
+		struct SlotEntry
+		{
+			Epoch epoch;
+			bool isModified;
+			std::list<SlotIndex>::iterator locator;
+		};
 
-			char value;
-		} ;
-		std::vector<UBits> listPages_;
+		std::list<SlotIndex>& getList(const SlotEntry& entry);
+		void moveSlot(SlotIndex slot, Epoch epoch, bool isModified, bool isFront = false);
+		void nextEpoch();
 
-		bool isRun_ = false;
+		std::vector<SlotEntry> slots_;
+		std::list<SlotIndex> referenced_[2];		//indexed by the modified bit
+		std::list<SlotIndex> notReferenced_[2];
+		Epoch epoch_ = 1;
 		unsigned long timerInterval_ = 200;
-		void threadTimer();
-		std::thread timer_;
-		std::mutex mutexTimer_;
-		std::condition_variable cvWaitTimer_;
-
+		std::chrono::steady_clock::time_point epochStart_;
 	};
 
 	class caRandom: public CacheAlgorithm
@@ -114,15 +321,323 @@ namespace cache
 		void setSeed(unsigned int seedValue = 0);
 		void setPageCount(PageCount pageCount) override;
 		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
 		void reset() override {}
-		void onPageOperation(PageNumber page, PageOperation pageOperation) override {}
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override {}
 		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
 		AlgoritmParameterValue getParameter(const char* paramName) const override;
-	private:
+	protected:
 		std::mt19937 generator_;
 		PageCount pageCount_;
 		unsigned int seed_;
 	};
 
+	//Approximate LRU: the oldest page of a random sample is evicted, only the last access time is kept per slot
+	class caSampledLRU : public caRandom
+	{
+	public:
+		caSampledLRU(unsigned int seedValue = 0) : caRandom(seedValue) {}
+		void setPageCount(PageCount pageCount) override;
+		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+		void reset() override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+	private:
+		typedef unsigned int AccessTime;	//wraps around, 0 means a free slot
+
+		void touch(SlotIndex slot);
+		PageNumber sampleVictim(std::mt19937& generator) const;
+
+		std::vector<AccessTime> accessTime_;
+		std::vector<SlotIndex> freeSlots_;	//slots freed by reset
+		SlotIndex nextFree_ = 0;			//slots from here were never used
+		AccessTime clock_ = 0;
+		size_t samples_ = 5;
+	};
+
+	//Queue of the pages that were recently evicted from the cache (ghost entries)
+	class GhostQueue
+	{
+	public:
+		void push(PageNumber page);
+		bool remove(PageNumber page);
+		bool contains(PageNumber page) const;
+		void popOldest();
+		size_t size() const;
+		void clear();
+
+	private:
+		typedef std::list<PageNumber> PageQueue;
+
+		PageQueue queue_;
+		std::unordered_map<PageNumber, PageQueue::iterator> locator_;
+	};
+
+	//Count-min sketch of page access frequencies with 4-bit counters, the counters are halved periodically
+	class FrequencySketch
+	{
+	public:
+		void setSize(size_t pageCount);
+		void increment(PageNumber page);
+		unsigned int estimate(PageNumber page) const;
+		void clear();
+
+	private:
+		enum
+		{
+			SKETCH_DEPTH = 4,
+			COUNTER_MAX = 15
+		};
+
+		size_t getCounterIndex(PageNumber page, unsigned int row) const;
+		unsigned int getCounter(size_t index) const;
+		void halve();
+
+		std::vector<uint64_t> table_;
+		size_t width_ = 0;
+		size_t sampleSize_ = 0;
+		size_t sampleCount_ = 0;
+	};
+
+	//Base class for the algorithms that keep cache slots in several lists (the list 0 contains free slots)
+	class CacheAlgorithmLists : public CacheAlgorithm
+	{
+	public:
+		void setPageCount(PageCount pageCount) override;
+		void reset() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+
+	protected:
+		enum
+		{
+			LIST_FREE = 0
+		};
+
+		typedef std::list<SlotIndex> SlotList;
+
+		struct SlotEntry
+		{
+			unsigned int list;
+			SlotList::iterator locator;
+			PageNumber page;
+			bool isFirstAccess;
+		};
+
+		CacheAlgorithmLists(unsigned int listCount);
+		void moveSlot(SlotIndex slot, unsigned int list);
+		void freeSlot(SlotIndex slot);
+		bool isReplaceAccess(SlotIndex slot);
+		PageCount getPageCount() const;
+
+		//The victim if the algorithm can tell it without a change of its state, otherwise INVALID_SLOT
+		virtual SlotIndex peekReplacePage() const;
+
+		//False for the pages that the algorithm does not evict yet (for example, the pages with a second chance)
+		virtual bool isCandidate(SlotIndex slot) const;
+
+		std::vector<SlotList> lists_;
+		std::vector<SlotEntry> slots_;
+	};
+
+	//Adaptive Replacement Cache
+	class caARC : public CacheAlgorithmLists
+	{
+	public:
+		caARC();
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		enum
+		{
+			LIST_T1 = 1,
+			LIST_T2 = 2
+		};
+
+		SlotIndex peekReplacePage() const override;
+		void retainGhost(SlotIndex slot);
+		void trimGhosts();
+
+		GhostQueue b1_;
+		GhostQueue b2_;
+		size_t targetT1_ = 0;
+	};
+
+	//2Q: FIFO probation queue (A1in), main LRU queue (Am) and ghost queue (A1out)
+	class ca2Q : public CacheAlgorithmLists
+	{
+	public:
+		ca2Q();
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		enum
+		{
+			LIST_A1IN = 1,
+			LIST_AM = 2
+		};
+
+		SlotIndex peekReplacePage() const override;
+		size_t getSizeIn() const;
+		size_t getSizeOut() const;
+		void trimGhosts();
+
+		GhostQueue a1out_;
+		AlgoritmParameterValue ratioIn_ = 0.25;
+		AlgoritmParameterValue ratioOut_ = 0.5;
+	};
+
+	//Low Inter-reference Recency Set
+	class caLIRS : public CacheAlgorithmLists
+	{
+	public:
+		caLIRS();
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		enum
+		{
+			LIST_USED = 1
+		};
+
+		enum PageState
+		{
+			PAGE_LIR = 0,
+			PAGE_HIR_RESIDENT = 1,
+			PAGE_HIR_NONRESIDENT = 2
+		};
+
+		typedef std::list<PageNumber> PageStack;
+
+		struct PageEntry
+		{
+			PageState state;
+			SlotIndex slot;
+			bool isInStack;
+			PageStack::iterator stackLocator;
+			bool isInQueue;
+			PageStack::iterator queueLocator;
+			PageStack::iterator nonResidentLocator;
+		};
+
+		typedef std::unordered_map<PageNumber, PageEntry> PageTable;
+
+		size_t getLirLimit() const;
+		size_t getNonResidentLimit() const;
+		void accessPage(PageNumber storagePage);
+		void loadPage(SlotIndex slot, PageNumber storagePage);
+		void evictPage(PageNumber storagePage);
+		void erasePage(PageTable::iterator item);
+		void pushStack(PageNumber storagePage, PageEntry& entry);
+		void pushQueue(PageNumber storagePage, PageEntry& entry);
+		void removeQueue(PageEntry& entry);
+		void demoteBottomLir();
+		void pruneStack();
+		void trimNonResident();
+
+		PageTable pages_;
+		PageStack stack_;			//the bottom of the stack is the front of the list
+		PageStack queue_;			//resident HIR pages, the front is the next victim
+		PageStack nonResident_;		//non-resident HIR pages in the stack, from the oldest one
+		size_t lirCount_ = 0;
+		AlgoritmParameterValue ratioHir_ = 0.01;
+		AlgoritmParameterValue ratioNonResident_ = 2;
+	};
+
+	//Window TinyLFU: window LRU, segmented main LRU and frequency based admission
+	class caTinyLFU : public CacheAlgorithmLists
+	{
+	public:
+		caTinyLFU();
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		enum
+		{
+			LIST_WINDOW = 1,
+			LIST_PROBATION = 2,
+			LIST_PROTECTED = 3
+		};
+
+		SlotIndex peekReplacePage() const override;
+		size_t getWindowSize() const;
+		size_t getProtectedSize() const;
+		SlotIndex getMainVictim() const;
+
+		FrequencySketch sketch_;
+		AlgoritmParameterValue ratioWindow_ = 0.01;
+		AlgoritmParameterValue ratioProtected_ = 0.8;
+	};
+
+	//SIEVE: FIFO queue with a visited bit, the hand moves from the oldest page to the newest one
+	class caSieve : public CacheAlgorithmLists
+	{
+	public:
+		caSieve();
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount) override;
+
+	private:
+		enum
+		{
+			LIST_QUEUE = 1
+		};
+
+		void moveHand(SlotIndex slot);
+
+		SlotList::iterator hand_;
+		std::vector<bool> isVisited_;
+	};
+
+	//S3-FIFO: small probationary FIFO, main FIFO with reinsertion and ghost FIFO
+	class caS3FIFO : public CacheAlgorithmLists
+	{
+	public:
+		caS3FIFO();
+		void setPageCount(PageCount pageCount) override;
+		void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) override;
+		PageNumber getReplacePage() override;
+		void setParameter(const char* paramName, AlgoritmParameterValue paramValue) override;
+		AlgoritmParameterValue getParameter(const char* paramName) const override;
+
+	private:
+		enum
+		{
+			LIST_SMALL = 1,
+			LIST_MAIN = 2
+		};
+
+		enum
+		{
+			FREQUENCY_MAX = 3
+		};
+
+		bool isCandidate(SlotIndex slot) const override;
+		size_t getSmallSize() const;
+		void retainGhost(SlotIndex slot);
+
+		GhostQueue ghost_;
+		std::vector<unsigned char> frequency_;
+		AlgoritmParameterValue ratioSmall_ = 0.1;
+	};
 
-}; //namespace cache
+}; //namespace cache
\ No newline at end of file
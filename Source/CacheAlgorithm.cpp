@@ -31,6 +31,36 @@ CacheAlgorithm* CacheAlgorithm::create(ReplaceAlgoritm algoritm)
 	case ALG_RANDOM:
 		alg = new caRandom;
 		break;
+	case ALG_ARC:
+		alg = new caARC;
+		break;
+	case ALG_2Q:
+		alg = new ca2Q;
+		break;
+	case ALG_LIRS:
+		alg = new caLIRS;
+		break;
+	case ALG_TINYLFU:
+		alg = new caTinyLFU;
+		break;
+	case ALG_CLOCK_PRO:
+		alg = new caClockPro;
+		break;
+	case ALG_SIEVE:
+		alg = new caSieve;
+		break;
+	case ALG_S3FIFO:
+		alg = new caS3FIFO;
+		break;
+	case ALG_GREEDY_DUAL:
+		alg = new caGreedyDual;
+		break;
+	case ALG_LRU_K:
+		alg = new caLRUK;
+		break;
+	case ALG_SAMPLED_LRU:
+		alg = new caSampledLRU;
+		break;
 	}
 	alg->type_ = algoritm;
 
@@ -42,6 +72,17 @@ ReplaceAlgoritm CacheAlgorithm::getType() const
 	return type_;
 }
 
+void CacheAlgorithm::getReplaceCandidates(std::vector<PageNumber>& candidates, size_t)
+{
+	//getReplacePage may change the state of the algorithm (move a hand, clear reference bits), so it is not asked here
+	candidates.clear();
+}
+
+void CacheAlgorithm::onPageCost(PageNumber, AlgoritmParameterValue)
+{
+
+}
+
 void CacheAlgorithm::setParameter(const char* paramName, AlgoritmParameterValue paramValue)
 {
 	throw cache_exception(ERR_PARAMETER_NAME);
@@ -2,6 +2,8 @@
 
 #include "CacheTypes.h"
 
+#include <vector>
+
 namespace cache
 {
 	using namespace std;
@@ -13,10 +15,18 @@ namespace cache
 
 		virtual void setPageCount(PageCount pageCount) = 0;
 
-		virtual void onPageOperation(PageNumber page, PageOperation pageOperation) = 0;
+		//'page' is the slot index, 'storagePage' is the number of the storage page located in that slot
+		virtual void onPageOperation(PageNumber page, PageOperation pageOperation, PageNumber storagePage = INVALID_PAGE) = 0;
 
 		virtual PageNumber getReplacePage() = 0;
 
+		//Fills 'candidates' with up to 'maxCount' slots that can be evicted now, in the order of replacement preference.
+		//Unlike 'getReplacePage', it does not change the algorithm state, so the pages with a second chance are not returned
+		virtual void getReplaceCandidates(std::vector<PageNumber>& candidates, size_t maxCount);
+
+		//'cost' is the cost of the page loading to the slot 'page' (microseconds of the storage reading or the cost hint)
+		virtual void onPageCost(PageNumber page, AlgoritmParameterValue cost);
+
 		virtual void reset() = 0;
 
 		virtual void setParameter(const char* paramName, AlgoritmParameterValue paramValue);
@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <limits>
 #include <functional>
+#include <chrono>
 
 namespace cache
 {
@@ -26,6 +27,34 @@ namespace cache
 		WRITE_AROUND = 1
 	};
 
+	enum ReadMissPolicy
+	{
+		READ_ALLOCATE = 0,
+		READ_AROUND = 1
+	};
+
+	enum DeadlinePolicy
+	{
+		DEADLINE_TIMEOUT = 0,
+		DEADLINE_DIRECT_READ = 1
+	};
+
+	typedef std::chrono::steady_clock::time_point Deadline;	//Deadline::max() - no deadline
+
+	enum IoPriority
+	{
+		IO_DEMAND = 0,		//the data a caller waits for
+		IO_BACKGROUND = 1,	//prefetch and writeback
+		IO_PRIORITY_COUNT
+	};
+
+	struct StorageRange
+	{
+		DataAddress address;
+		DataSize size;
+		void* dataBuffer;
+	};
+
 	enum ReplaceAlgoritm
 	{
 		ALG_LRU = 0,
@@ -34,7 +63,17 @@ namespace cache
 		ALG_MRU,
 		ALG_CLOCK,
 		ALG_NRU,
-		ALG_RANDOM
+		ALG_RANDOM,
+		ALG_ARC,
+		ALG_2Q,
+		ALG_LIRS,
+		ALG_TINYLFU,
+		ALG_CLOCK_PRO,
+		ALG_SIEVE,
+		ALG_S3FIFO,
+		ALG_GREEDY_DUAL,
+		ALG_LRU_K,
+		ALG_SAMPLED_LRU
 	};
 
 	typedef double AlgoritmParameterValue;
@@ -51,11 +90,26 @@ namespace cache
 		PageSize  pageSize;
 		WritePolicy writePolicy;
 		WriteMissPolicy writeMissPolicy;
+		ReadMissPolicy readMissPolicy;
 		ReplaceAlgoritm replaceAlgoritm;
 		LocatorType     locatorType;
 		bool isEnabled;
 		bool isCleanBeforeLoad;
 		size_t hashMemoryLimit;
+		size_t reclaimBatch;
+		size_t cleanFirstCount;
+		size_t cleanFirstBias;
+		size_t freePoolLowWater;
+		size_t freePoolHighWater;
+		size_t writebackBuffers;
+		DeadlinePolicy deadlinePolicy;
+		double hedgePercentile;
+		size_t readLimit;
+		size_t writeLimit;
+		unsigned long schedulerWindow;
+		size_t loadThreads;
+		DataSize bypassThreshold;
+		double bypassZeroHitRatio;
 	};
 
 
@@ -65,6 +119,19 @@ namespace cache
 		unsigned long hitCount;
 		unsigned long missCount;
 		unsigned long directCount;
+		unsigned long writebackCount;
+		unsigned long cleanFirstSkipCount;
+		unsigned long stagedWriteCount;
+		unsigned long timeoutCount;
+		unsigned long hedgedReadCount;
+		unsigned long hedgedWinCount;
+		unsigned long ioQueuedCount;
+		unsigned long ioWaitTime;
+		unsigned long ioQueueDepth;
+		unsigned long ioMaxQueueDepth;
+		unsigned long ioMergedCount;
+		unsigned long bypassCount;
+		unsigned long bypassBytes;
 		unsigned long locatorMemory;
 	};
 
@@ -78,7 +145,8 @@ namespace cache
 		PAGE_WRITE = 1,
 		PAGE_REPLACE = 2,
 		PAGE_RESET = 3,
-		PAGE_FLUSH = 4
+		PAGE_FLUSH = 4,
+		PAGE_EVICT = 5		//The page 'storagePage' is evicted and the slot becomes free
 	};
 	
 	enum DebugInformation
@@ -106,7 +174,9 @@ namespace cache
 		TRACE_READ,
 		TRACE_WRITE,
 		TRACE_READ_PAGE,
-		TRACE_WRITE_PAGE
+		TRACE_WRITE_PAGE,
+		TRACE_RECLAIM,
+		TRACE_HEDGE
 	};
 
 	typedef std::function<void(DebugTracePoint)> CallbackTracePoint;
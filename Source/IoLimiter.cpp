@@ -0,0 +1,111 @@
+#include "IoLimiter.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+
+using namespace cache;
+
+void IoLimiter::setLimit(size_t limit)
+{
+	limit_ = limit;
+	cvQueue_.notify_all();
+}
+
+size_t IoLimiter::getLimit() const
+{
+	return limit_;
+}
+
+void IoLimiter::acquire(locker_t& locker, IoPriority priority)
+{
+	if (getQueueDepth() == 0 && (limit_ == 0 || activeCount_ < limit_))
+	{
+		activeCount_++;
+		return;
+	}
+
+	unsigned long ticket = nextTicket_++;
+	queues_[priority].push_back(ticket);
+	maxQueueDepth_ = std::max(maxQueueDepth_, getQueueDepth());
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	cvQueue_.wait(locker, [this, priority, ticket]()
+	{
+		return this->canStart(priority, ticket);
+	});
+
+	queues_[priority].pop_front();
+	activeCount_++;
+
+	queuedCount_++;
+	waitTime_ += (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+	//The next request in the queue can start too if the limit was raised
+	cvQueue_.notify_all();
+}
+
+void IoLimiter::release()
+{
+	assert(activeCount_ > 0); //software error: 'release' was called without previous 'acquire' call
+	activeCount_--;
+
+	if (getQueueDepth() > 0)
+	{
+		cvQueue_.notify_all();
+	}
+}
+
+bool IoLimiter::canStart(IoPriority priority, unsigned long ticket) const
+{
+	if (limit_ != 0 && activeCount_ >= limit_)
+	{
+		return false;
+	}
+
+	//The requests of a higher priority go first, the requests of the same priority go in the arrival order
+	for (int higher = 0; higher < priority; higher++)
+	{
+		if (!queues_[higher].empty())
+		{
+			return false;
+		}
+	}
+
+	return queues_[priority].front() == ticket;
+}
+
+size_t IoLimiter::getQueueDepth() const
+{
+	size_t depth = 0;
+
+	for (const auto& queue : queues_)
+	{
+		depth += queue.size();
+	}
+
+	return depth;
+}
+
+size_t IoLimiter::getMaxQueueDepth() const
+{
+	return maxQueueDepth_;
+}
+
+unsigned long IoLimiter::getQueuedCount() const
+{
+	return queuedCount_;
+}
+
+unsigned long IoLimiter::getWaitTime() const
+{
+	return waitTime_;
+}
+
+void IoLimiter::resetStatistic()
+{
+	maxQueueDepth_ = getQueueDepth();
+	queuedCount_ = 0;
+	waitTime_ = 0;
+}
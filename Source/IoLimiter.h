@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CacheTypes.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace cache
+{
+	class IoLimiter
+	{
+	public:
+		typedef std::unique_lock<std::mutex> locker_t;
+
+		void setLimit(size_t limit);
+		size_t getLimit() const;
+
+		void acquire(locker_t& locker, IoPriority priority);
+		void release();
+
+		size_t getQueueDepth() const;
+		size_t getMaxQueueDepth() const;
+		unsigned long getQueuedCount() const;
+		unsigned long getWaitTime() const;
+		void resetStatistic();
+
+	private:
+		size_t limit_ = 0;	//0 - no limit
+		size_t activeCount_ = 0;
+		unsigned long nextTicket_ = 0;
+		std::deque<unsigned long> queues_[IO_PRIORITY_COUNT];	//tickets in the arrival order
+		std::condition_variable cvQueue_;
+
+		size_t maxQueueDepth_ = 0;
+		unsigned long queuedCount_ = 0;
+		unsigned long waitTime_ = 0;	//microseconds
+
+		bool canStart(IoPriority priority, unsigned long ticket) const;
+	};
+
+}; //namespace cache
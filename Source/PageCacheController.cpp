@@ -4,9 +4,13 @@
 #include "PageAddressIterator.h"
 #include "PageSlot.h"
 #include "PageLocator.h"
+#include "IoLimiter.h"
 
 #include <assert.h>
 #include <stdarg.h>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
 
 using namespace cache;
 
@@ -26,6 +30,30 @@ if (callbackLog_) \
 	log(format, __VA_ARGS__); \
 }
 
+//openPage results: the deadline has passed while the page was loaded by another thread,
+//or while the storage did not have the last data of the page (it was unloaded or taken from a writeback buffer)
+const SlotIndex TIMEOUT_SLOT = INVALID_SLOT - 1;
+const SlotIndex TIMEOUT_DIRTY_SLOT = INVALID_SLOT - 3;
+
+//miss result: the lock was released to write the staged copy of the page, the lookup starts again
+const SlotIndex RETRY_SLOT = INVALID_SLOT - 2;
+
+//The load latencies kept for the hedged reads, and how many of them are needed before the first hedge
+const size_t LATENCY_SAMPLES = 256;
+const size_t MIN_LATENCY_SAMPLES = 16;
+
+//The evictions kept for the thrash detection; every probe interval a stream is cached anyway to renew them
+const size_t EVICTION_SAMPLES = 64;
+const unsigned long BYPASS_PROBE_INTERVAL = 16;
+const size_t STREAM_SLOTS = 16;
+
+//The bytes of one vectored write of the flush and of one vectored read of the loaders; a larger page goes alone
+const size_t FLUSH_CHUNK_SIZE = 1024 * 1024;
+
+//The hedged reads of all callers share this number of helper threads; a thread idle for the given time retires
+const size_t HEDGE_THREADS_MAX = 16;
+const unsigned long HEDGE_IDLE_MILLISECONDS = 1000;
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //Main class
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -33,14 +61,33 @@ PageCacheController::PageCacheController()
 {
 	pageReplaceAlgoritm.reset(CacheAlgorithm::create(ALG_LRU));
 	pageLocator_.reset(new PageLocator);
+	readLimiter_.reset(new IoLimiter);
+	writeLimiter_.reset(new IoLimiter);
 	cacheBuffer_ = nullptr;
 }
 
 PageCacheController::~PageCacheController()
 {
+	//The derived class stops the threads by shutdown, here only a thread left by mistake is joined
+	stopLoadThreads();
+	stopPreCleaner();
+	stopStagingWriter();
+	stopHedgeThreads();
+
 	delete cacheBuffer_;
 }
 
+void PageCacheController::shutdown()
+{
+	setLoadThreads(0);
+	setHedgedRead(0);
+	setCleanFirst(0, 0);
+	setFreePool(0, 0);
+
+	//The last one: it writes the pending buffers and can throw
+	setWritebackBuffers(0);
+}
+
 void PageCacheController::setStartPageOffset(PageOffset offset) 
 {
 	startPageOffset_ = offset; 
@@ -56,6 +103,191 @@ void PageCacheController::setCleanBeforeLoad(bool isCleanBeforeLoad)
 	isCleanBeforeLoad_ = isCleanBeforeLoad; 
 }
 
+void PageCacheController::setReclaimBatch(size_t batchSize)
+{
+	std::lock_guard<std::mutex> lock(synchronizer);
+	reclaimBatch_ = batchSize;
+}
+
+void PageCacheController::setCleanFirst(size_t candidateCount, size_t dirtyBias)
+{
+	//The pre-cleaner writes back the dirty candidates that the policy passes over
+	stopPreCleaner();
+
+	locker_t locker(synchronizer);
+	cleanFirstCount_ = candidateCount;
+	cleanFirstBias_ = dirtyBias;
+	cleanQueue_.clear();
+
+	startPreCleaner();
+}
+
+void PageCacheController::setFreePool(size_t lowWaterMark, size_t highWaterMark)
+{
+	stopPreCleaner();
+
+	locker_t locker(synchronizer);
+	lowWaterMark_ = lowWaterMark;
+	highWaterMark_ = std::max(lowWaterMark, highWaterMark);
+
+	if (lowWaterMark_ > 0)
+	{
+		//The slots taken by the algorithm while the pool was off are not counted as free
+		freeSlots_.erase(std::remove_if(freeSlots_.begin(), freeSlots_.end(), [this](SlotIndex slotIndex)
+		{
+			return this->pageSlotTable_[slotIndex]->state != PageSlot::STATE_FREE || !this->pageSlotTable_[slotIndex]->isAvailable();
+		}), freeSlots_.end());
+	}
+
+	startPreCleaner();
+}
+
+void PageCacheController::startPreCleaner()
+{
+	if (lowWaterMark_ > 0 || cleanFirstCount_ > 0)
+	{
+		isPreCleanerRun_ = true;
+		preCleaner_ = std::thread(&PageCacheController::threadPreCleaner, this);
+	}
+}
+
+void PageCacheController::stopPreCleaner()
+{
+	locker_t locker(synchronizer);
+	isPreCleanerRun_ = false;
+	cvPreCleaner_.notify_all();
+	locker.unlock();
+
+	if (preCleaner_.joinable())
+	{
+		preCleaner_.join();
+	}
+}
+
+void PageCacheController::setWritebackBuffers(size_t bufferCount)
+{
+	stopStagingWriter();
+
+	locker_t locker(synchronizer);
+
+	try
+	{
+		//The evicted pages that are still in the buffers go to the storage first
+		flushStagedWrites(locker, 0, INVALID_PAGE);
+	}
+	catch (...)
+	{
+		startStagingWriter();
+		std::rethrow_exception(std::current_exception());
+	}
+
+	stagedWrites_.assign(bufferCount, StagedWrite());
+	stagingMemory_.assign(bufferCount * pageSize_, 0);
+
+	startStagingWriter();
+}
+
+void PageCacheController::setHedgedRead(double percentile)
+{
+	//The reads that lost the race are waited for
+	stopHedgeThreads();
+
+	std::lock_guard<std::mutex> lock(synchronizer);
+	hedgePercentile_ = std::min(percentile, 100.0);
+	isHedgeRun_ = hedgePercentile_ > 0;
+	loadLatencies_.clear();
+	nextLatency_ = 0;
+}
+
+void PageCacheController::stopHedgeThreads()
+{
+	locker_t locker(synchronizer);
+	isHedgeRun_ = false;
+	cvHedge_.notify_all();
+	locker.unlock();
+
+	for (auto& reader : hedgeThreads_)
+	{
+		reader.join();
+	}
+	hedgeThreads_.clear();
+	retiredHedgeThreads_.clear();
+}
+
+void PageCacheController::joinRetiredHedgeThreads()
+{
+	//A retired thread has returned from its function, so the join does not wait for the lock
+	for (std::thread::id id : retiredHedgeThreads_)
+	{
+		auto reader = std::find_if(hedgeThreads_.begin(), hedgeThreads_.end(), [id](const std::thread& thread)
+		{
+			return thread.get_id() == id;
+		});
+
+		reader->join();
+		hedgeThreads_.erase(reader);
+	}
+	retiredHedgeThreads_.clear();
+}
+
+void PageCacheController::setIoLimit(size_t readLimit, size_t writeLimit)
+{
+	std::lock_guard<std::mutex> lock(synchronizer);
+	readLimiter_->setLimit(readLimit);
+	writeLimiter_->setLimit(writeLimit);
+}
+
+void PageCacheController::setIoScheduler(unsigned long windowMicroseconds)
+{
+	std::lock_guard<std::mutex> lock(synchronizer);
+	schedulerWindow_ = windowMicroseconds;
+}
+
+void PageCacheController::setBypass(DataSize sizeThreshold, double zeroHitRatio)
+{
+	std::lock_guard<std::mutex> lock(synchronizer);
+	bypassThreshold_ = sizeThreshold;
+	bypassZeroHitRatio_ = std::min(zeroHitRatio, 1.0);
+	evictionSamples_.clear();
+	nextEviction_ = 0;
+	zeroHitEvictions_ = 0;
+	bypassProbe_ = 0;
+	streamEnds_.clear();
+	nextStream_ = 0;
+}
+
+void PageCacheController::setLoadThreads(size_t threadCount)
+{
+	stopLoadThreads();
+
+	std::lock_guard<std::mutex> lock(synchronizer);
+	startLoadThreads(threadCount);
+}
+
+void PageCacheController::startLoadThreads(size_t threadCount)
+{
+	isLoaderRun_ = threadCount > 0;
+
+	for (size_t index = 0; index < threadCount; index++)
+	{
+		loadThreads_.push_back(std::thread(&PageCacheController::threadLoader, this));
+	}
+}
+
+void PageCacheController::stopLoadThreads()
+{
+	locker_t locker(synchronizer);
+	isLoaderRun_ = false;
+	cvLoader_.notify_all();
+	locker.unlock();
+
+	for (auto& loader : loadThreads_)
+	{
+		loader.join();
+	}
+	loadThreads_.clear();
+}
+
 void PageCacheController::setupPages(PageCount pageCount, PageSize pageSize)
 {
 	if (pageCount == 0 || pageSize == 0)
@@ -63,17 +295,27 @@ void PageCacheController::setupPages(PageCount pageCount, PageSize pageSize)
 		throw cache_exception(ERR_PAGE_COUNT_SIZE);
 	}
 
-	pageSlotTable_.clear();
-	pageLocator_->clear();
-	
-	delete cacheBuffer_;
-	cacheBuffer_ = new byte_t[pageCount * pageSize];
+	byte_t* cacheBuffer = new byte_t[pageCount * pageSize];
 
-	if (cacheBuffer_ == nullptr)
+	if (cacheBuffer == nullptr)
 	{
 		throw cache_exception(ERR_ALLOCATE_BUFFER);
 	}
 
+	//The background threads hold slots without the lock: they are stopped while the table is rebuilt
+	size_t loadThreadCount = loadThreads_.size();
+	stopLoadThreads();
+	stopPreCleaner();
+	stopStagingWriter();
+
+	locker_t locker(synchronizer);
+
+	pageSlotTable_.clear();
+	pageLocator_->clear();
+	
+	delete cacheBuffer_;
+	cacheBuffer_ = cacheBuffer;
+
 	pageSize_ = pageSize;
 
 	::memset(cacheBuffer_, 0, pageCount * pageSize);
@@ -84,14 +326,44 @@ void PageCacheController::setupPages(PageCount pageCount, PageSize pageSize)
 	{
 		pageSlotTable_.push_back(std::make_unique<PageSlot>());
 	}
+
+	resetFreeSlots();
+
+	//The buffers follow the page size; the evicted pages are dropped as the cached ones
+	stagedWrites_.assign(stagedWrites_.size(), StagedWrite());
+	stagingMemory_.assign(stagedWrites_.size() * pageSize_, 0);
+
+	startStagingWriter();
+	startPreCleaner();
+	startLoadThreads(loadThreadCount);
 }
 
 void PageCacheController::read(DataAddress address, DataSize size, void* readBuffer, void* metaData)
+{
+	read(address, size, readBuffer, Deadline::max(), metaData);
+}
+
+void PageCacheController::write(DataAddress address, DataSize size, const void* writeBuffer, void* metaData)
+{
+	write(address, size, writeBuffer, Deadline::max(), metaData);
+}
+
+void PageCacheController::read(DataAddress address, DataSize size, void* readBuffer, ReadMissPolicy policy, void* metaData)
+{
+	read(address, size, readBuffer, Deadline::max(), policy, metaData);
+}
+
+bool PageCacheController::read(DataAddress address, DataSize size, void* readBuffer, const Deadline& deadline, void* metaData)
+{
+	return read(address, size, readBuffer, deadline, readMissPolicy_, metaData);
+}
+
+bool PageCacheController::read(DataAddress address, DataSize size, void* readBuffer, const Deadline& deadline, ReadMissPolicy policy, void* metaData)
 {
 	if (!isEnabled_)
 	{
-		readStorage(address, size, readBuffer, metaData);
-		return;
+		directRead(address, size, readBuffer, metaData);
+		return true;
 	}
 
 	if (cacheBuffer_ == nullptr)
@@ -99,35 +371,111 @@ void PageCacheController::read(DataAddress address, DataSize size, void* readBuf
 		throw cache_exception(ERR_BUFFER_NOT_ALLOCATED);
 	}
 
+	bool isBypass = policy == READ_ALLOCATE && checkBypass(address, size);
+	if (isBypass)
+	{
+		policy = READ_AROUND;
+	}
+
+	LoadBatch batch;
+	if (policy == READ_ALLOCATE)
+	{
+		startLoadAhead(batch, address, size, metaData);
+	}
+
+	bool isCompleted = false;
+	DataSize directBytes = 0;
+
+	try
+	{
+		isCompleted = readPages(address, size, readBuffer, deadline, policy, metaData, directBytes);
+	}
+	catch (...)
+	{
+		finishLoadAhead(batch);
+		std::rethrow_exception(std::current_exception());
+	}
+
+	finishLoadAhead(batch);
+
+	if (isBypass)
+	{
+		addBypassBytes(directBytes);
+	}
+
+	return isCompleted;
+}
+
+bool PageCacheController::readPages(DataAddress address, DataSize size, void* readBuffer, const Deadline& deadline, ReadMissPolicy policy, void* metaData, DataSize& directBytes)
+{
 	PageAddressIterator pageIterator(pageSize_, startPageOffset_, address, size, readBuffer);
 
+	//The adjacent pages that are not taken into the cache are read by one call straight to the user buffer
+	DataAddress directAddress = 0;
+	DataSize directSize = 0;
+	void* directBuffer = nullptr;
+
 	while (pageIterator.isValid())
 	{
-		SlotIndex slotIndex = openPage(pageIterator.getPage(), PAGE_READ, metaData);
+		SlotIndex slotIndex = openPage(pageIterator.getPage(), PAGE_READ, metaData, deadline, policy == READ_AROUND);
+
+		if (slotIndex == INVALID_SLOT)
+		{
+			//Read around or no free pages
+			if (directSize == 0)
+			{
+				directAddress = pageIterator.getAddress();
+				directBuffer = pageIterator.getBuffer();
+			}
+			directSize += pageIterator.getSize();
+
+			pageIterator++;
+			continue;
+		}
+
+		if (directSize > 0)
+		{
+			directRead(directAddress, directSize, directBuffer, metaData);
+			directBytes += directSize;
+			directSize = 0;
+		}
+
+		if (slotIndex == TIMEOUT_SLOT || slotIndex == TIMEOUT_DIRTY_SLOT)
+		{
+			if (deadlinePolicy_ == DEADLINE_TIMEOUT || slotIndex == TIMEOUT_DIRTY_SLOT)
+			{
+				return false;
+			}
 
-		if (slotIndex != INVALID_SLOT)
+			//The load goes on, only the requested range is read from the storage
+			directRead(pageIterator.getAddress(), pageIterator.getSize(), pageIterator.getBuffer(), metaData);
+		}
+		else
 		{
 			TRACE_POINT(TRACE_READ_PAGE);
 			void* cacheData = calcSlotMemory(slotIndex, pageIterator.getPageOffset());
 			::memcpy(pageIterator.getBuffer(), cacheData, pageIterator.getSize());
 			closePage(slotIndex, PAGE_READ, metaData);
 		}
-		else
-		{
-			//No free pages
-			readStorage(pageIterator.getAddress(), pageIterator.getSize(), pageIterator.getBuffer(), metaData);
-		}
 
 		pageIterator++;
 	}
+
+	if (directSize > 0)
+	{
+		directRead(directAddress, directSize, directBuffer, metaData);
+		directBytes += directSize;
+	}
+
+	return true;
 }
 
-void PageCacheController::write(DataAddress address, DataSize size, const void* writeBuffer, void* metaData)
+bool PageCacheController::write(DataAddress address, DataSize size, const void* writeBuffer, const Deadline& deadline, void* metaData)
 {
 	if (!isEnabled_)
 	{
-		writeStorage(address, size, writeBuffer, metaData);
-		return;
+		directWrite(address, size, writeBuffer, metaData);
+		return true;
 	}
 
 	if (cacheBuffer_ == nullptr)
@@ -135,352 +483,1745 @@ void PageCacheController::write(DataAddress address, DataSize size, const void*
 		throw cache_exception(ERR_BUFFER_NOT_ALLOCATED);
 	}
 
+	bool isBypass = writeMissPolicy_ == WRITE_ALLOCATE && checkBypass(address, size);
+	bool isAround = isBypass || writeMissPolicy_ == WRITE_AROUND;
+
 	PageAddressIterator pageIterator(pageSize_, startPageOffset_, address, size, const_cast<void*> (writeBuffer));
 
+	//The adjacent pages that are not taken into the cache are written by one call from the user buffer
+	DataAddress directAddress = 0;
+	DataSize directSize = 0;
+	void* directBuffer = nullptr;
+	DataSize directBytes = 0;
+
 	while (pageIterator.isValid())
 	{
-		SlotIndex slotIndex = openPage(pageIterator.getPage(), PAGE_WRITE, metaData);
-
-		if (slotIndex != INVALID_SLOT)
+		SlotIndex slotIndex = openPage(pageIterator.getPage(), PAGE_WRITE, metaData, deadline, isAround);
+
+		if (slotIndex == INVALID_SLOT)
+		{
+			//Write around or no free pages
+			if (directSize == 0)
+			{
+				directAddress = pageIterator.getAddress();
+				directBuffer = pageIterator.getBuffer();
+			}
+			directSize += pageIterator.getSize();
+
+			pageIterator++;
+			continue;
+		}
+
+		if (directSize > 0)
+		{
+			directWrite(directAddress, directSize, directBuffer, metaData);
+			directBytes += directSize;
+			directSize = 0;
+		}
+
+		if (slotIndex == TIMEOUT_SLOT || slotIndex == TIMEOUT_DIRTY_SLOT)
+		{
+			//A direct write would be lost when the load completes, so a write always gives up
+			return false;
+		}
+
+		TRACE_POINT(TRACE_WRITE_PAGE);
+		void* cacheData = calcSlotMemory(slotIndex, pageIterator.getPageOffset());
+		::memcpy(cacheData, pageIterator.getBuffer(), pageIterator.getSize());
+		closePage(slotIndex, PAGE_WRITE, metaData);
+
+		if (writePolicy_ == WRITE_THROUGH)
+		{
+			directWrite(pageIterator.getAddress(), pageIterator.getSize(), pageIterator.getBuffer(), metaData);
+		}
+
+		pageIterator++;
+	}
+
+	if (directSize > 0)
+	{
+		directWrite(directAddress, directSize, directBuffer, metaData);
+		directBytes += directSize;
+	}
+
+	if (isBypass)
+	{
+		addBypassBytes(directBytes);
+	}
+
+	return true;
+}
+
+void PageCacheController::flush(void* metaData)
+{
+	locker_t locker(synchronizer);
+	flushStagedWrites(locker, 0, INVALID_PAGE);
+
+	std::vector<SlotIndex> slots;
+
+	for (SlotIndex index = 0; index < pageSlotTable_.size(); index++)
+	{
+		if (pageSlotTable_[index]->canFlush())
+		{
+			slots.push_back(index);
+		}
+	}
+
+	flushPages(locker, slots, metaData);
+}
+
+void PageCacheController::flush(DataAddress address, DataSize size, void* metaData)
+{
+	PageAddressIterator pageIterator(pageSize_, startPageOffset_, address, size);
+
+	if (!pageIterator.isValid())
+	{
+		return;
+	}
+
+	locker_t locker(synchronizer);
+
+	PageNumber firstPage = pageIterator.getPage();
+	PageNumber lastPage = PageAddressIterator(pageSize_, startPageOffset_, address + size - 1, 1).getPage();
+	flushStagedWrites(locker, firstPage, lastPage);
+
+	std::vector<SlotIndex> slots;
+
+	for (; pageIterator.isValid(); pageIterator++)
+	{
+		SlotIndex index = pageLocator_->get(pageIterator.getPage());
+		if (index != INVALID_SLOT && pageSlotTable_[index]->canFlush())
+		{
+			slots.push_back(index);
+		}
+	}
+
+	flushPages(locker, slots, metaData);
+}
+
+void PageCacheController::flushPages(locker_t& locker, std::vector<SlotIndex>& slots, void* metaData, IoPriority priority)
+{
+	if (slots.empty())
+	{
+		return;
+	}
+
+	//The dirty pages go to the storage in the address order, as vectors of a bounded size.
+	//The pages of a chunk stay captured only until the chunk is written
+	std::sort(slots.begin(), slots.end(), [this](SlotIndex left, SlotIndex right)
+	{
+		return pageSlotTable_[left]->page < pageSlotTable_[right]->page;
+	});
+
+	const size_t chunkPages = std::max<size_t>(1, FLUSH_CHUNK_SIZE / pageSize_);
+
+	for (size_t first = 0; first < slots.size(); first += chunkPages)
+	{
+		const size_t last = std::min(first + chunkPages, slots.size());
+		std::vector<StorageRange> ranges;
+
+		for (size_t index = first; index < last; index++)
+		{
+			PageSlot& descriptor = *pageSlotTable_[slots[index]];
+
+			descriptor.isDirty = false;
+			descriptor.addCapture(); TRACE_POINT(TRACE_ADD_CAPTURE);
+			ranges.push_back({ calcPageAddress(descriptor.page), pageSize_, calcSlotMemory(slots[index]) });
+		}
+
+		try
+		{
+			executeWriteV(locker, ranges, metaData, priority);
+		}
+		catch (...)
+		{
+			for (size_t index = first; index < last; index++)
+			{
+				pageSlotTable_[slots[index]]->isDirty = true;
+				pageSlotTable_[slots[index]]->releaseCapture();
+			}
+			std::rethrow_exception(std::current_exception());
+		}
+
+		for (size_t index = first; index < last; index++)
+		{
+			PageSlot& descriptor = *pageSlotTable_[slots[index]];
+
+			descriptor.releaseCapture(); TRACE_POINT(TRACE_RELEASE_CAPTURE);
+			pageReplaceAlgoritm->onPageOperation(slots[index], PAGE_FLUSH, descriptor.page);
+		}
+	}
+}
+
+void PageCacheController::clear()
+{
+	if (cacheBuffer_ == nullptr)
+	{
+		throw cache_exception(ERR_BUFFER_NOT_ALLOCATED);
+	}
+
+	//The pre-cleaner and the loaders hold slots without the lock
+	size_t loadThreadCount = loadThreads_.size();
+	stopLoadThreads();
+	stopPreCleaner();
+
+	locker_t locker(synchronizer);
+
+	for (auto& descriptor : pageSlotTable_)
+	{
+		descriptor->reset();
+	}
+
+	::memset(cacheBuffer_, 0, pageSlotTable_.size() * pageSize_);
+
+	pageReplaceAlgoritm->reset();
+
+	resetFreeSlots();
+
+	pageLocator_->clear();
+
+	startPreCleaner();
+	startLoadThreads(loadThreadCount);
+}
+
+
+SlotIndex PageCacheController::openPage(PageNumber pageNumber, PageOperation pageOperation, void* metaData, const Deadline& deadline, bool isAround)
+{
+	locker_t locker(synchronizer);
+
+	operationCount_++;
+
+	SlotIndex searchIndex = RETRY_SLOT;
+
+	while (searchIndex == RETRY_SLOT)
+	{
+		searchIndex = pageLocator_->get(pageNumber);
+	
+		if (searchIndex == INVALID_SLOT)
+		{
+			searchIndex = miss(pageNumber, pageOperation, locker, metaData, isAround);
+		}
+		else
+		{
+			searchIndex = hit(searchIndex, pageNumber, pageOperation, locker, metaData, deadline, isAround);
+		}
+	}
+
+	return searchIndex;
+}
+
+void PageCacheController::closePage(SlotIndex slotIndex, PageOperation pageOperation, void* metaData)
+{	
+	locker_t locker(synchronizer);
+
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	if (writePolicy_ != WRITE_THROUGH && pageOperation == PAGE_WRITE)
+	{
+		descriptor.isDirty = true;
+	}
+
+	descriptor.releaseCapture(); TRACE_POINT(TRACE_RELEASE_CAPTURE);
+}
+
+SlotIndex PageCacheController::hit(SlotIndex slotIndex, PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData, const Deadline& deadline, bool isAround)
+{
+	TRACE_POINT(TRACE_HIT);
+
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	//The first touch of a page loaded ahead is the miss the loader has counted
+	if (descriptor.isPrefetched && descriptor.page == pageNumber)
+	{
+		descriptor.isPrefetched = false;
+	}
+	else
+	{
+		hitCount_++;
+		descriptor.hitCount++;
+	}
+
+	if (descriptor.isPageUnload(pageNumber)) 
+	{
+		TRACE_POINT(TRACE_WAIT_UNLOAD);
+
+		if (!descriptor.waitUnload(locker, deadline))
+		{
+			timeoutCount_++;
+			return TIMEOUT_DIRTY_SLOT;
+		}
+
+		SlotIndex index = pageLocator_->get(pageNumber);
+
+		if (index != INVALID_SLOT) //another thread could have already located this page
+		{
+			slotIndex = hit(index, pageNumber, pageOperation, locker, metaData, deadline, isAround);
+			//We have to repeat a hit, because the page can be in waiting state
+		}
+		else
+		{
+			slotIndex = miss(pageNumber, pageOperation, locker, metaData, isAround);
+		}
+	}
+	else
+	{
+		TRACE_POINT(TRACE_WAIT_LOAD);
+
+		if (descriptor.isLoading() && !descriptor.waitLoad(locker, deadline))
+		{
+			timeoutCount_++;
+			return isStaged(pageNumber) ? TIMEOUT_DIRTY_SLOT : TIMEOUT_SLOT;
+		}
+
+		markCapture(slotIndex, pageOperation, metaData);
+	}
+
+	return slotIndex;
+}
+
+
+SlotIndex PageCacheController::miss(PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData, bool isAround)
+{
+	TRACE_POINT(TRACE_MISS);
+
+	missCount_++;
+
+	//The storage is bypassed only if the writeback buffers do not hold a newer copy of the page
+	if (isAround && !isStaged(pageNumber))
+	{
+		return INVALID_SLOT;
+	}
+
+	SlotIndex searchSlot = selectSlot();
+
+	if (searchSlot != INVALID_SLOT)
+	{
+		replacePage(searchSlot, pageNumber, pageOperation, locker, metaData);
+		markCapture(searchSlot, pageOperation, metaData);
+	}
+	else
+	{
+		//It might occure that all pages are in replace state.
+		//The storage is accessed directly then, so a staged copy of the page is written first
+		if (writeStagedPage(locker, pageNumber))
+		{
+			return RETRY_SLOT;
+		}
+
+		directCount_++;
+	}
+
+	return searchSlot;
+}
+
+SlotIndex PageCacheController::selectSlot()
+{
+	SlotIndex searchSlot = INVALID_SLOT;
+
+	if (reclaimBatch_ > 0 || lowWaterMark_ > 0)
+	{
+		searchSlot = takeFreeSlot();
+		if (searchSlot == INVALID_SLOT && reclaimBatch_ > 0)
+		{
+			reclaimSlots();
+			searchSlot = takeFreeSlot();
+		}
+
+		if (freeSlots_.size() < lowWaterMark_)
+		{
+			cvPreCleaner_.notify_one();
+		}
+	}
+
+	if (searchSlot == INVALID_SLOT)
+	{
+		searchSlot = pageReplaceAlgoritm->getReplacePage();
+
+		if (searchSlot != INVALID_SLOT && cleanFirstCount_ > 1 && pageSlotTable_[searchSlot]->isDirty)
+		{
+			searchSlot = findCleanCandidate(searchSlot);
+		}
+	}
+
+	if (searchSlot != INVALID_SLOT && !pageSlotTable_[searchSlot]->isAvailable())
+	{
+		searchSlot = findReplaceCandidate();
+	}
+
+	return searchSlot;
+}
+
+void PageCacheController::resetFreeSlots()
+{
+	freeSlots_.clear();
+
+	for (SlotIndex slotIndex = pageSlotTable_.size(); slotIndex > 0; slotIndex--)
+	{
+		freeSlots_.push_back(slotIndex - 1);
+	}
+}
+
+SlotIndex PageCacheController::takeFreeSlot()
+{
+	while (!freeSlots_.empty())
+	{
+		SlotIndex slotIndex = freeSlots_.back();
+		freeSlots_.pop_back();
+
+		//The slot could have been taken by the algorithm after it was released
+		if (pageSlotTable_[slotIndex]->state == PageSlot::STATE_FREE && pageSlotTable_[slotIndex]->isAvailable())
+		{
+			return slotIndex;
+		}
+	}
+
+	return INVALID_SLOT;
+}
+
+void PageCacheController::reclaimSlots()
+{
+	TRACE_POINT(TRACE_RECLAIM);
+
+	//Only clean pages that nobody uses are reclaimed, so no storage operation is needed; dirty victims are replaced one by one
+	pageReplaceAlgoritm->getReplaceCandidates(replaceCandidates_, std::min(reclaimBatch_, pageSlotTable_.size()));
+
+	for (PageNumber candidate : replaceCandidates_)
+	{
+		if (candidate >= pageSlotTable_.size())
+		{
+			continue;
+		}
+
+		PageSlot& descriptor = *pageSlotTable_[candidate];
+
+		if (descriptor.state == PageSlot::STATE_READY && !descriptor.isDirty && descriptor.isAvailable() && descriptor.getCaptureCount() == 0)
+		{
+			releaseSlot(candidate);
+		}
+		else if (descriptor.state == PageSlot::STATE_FREE && descriptor.isAvailable())
+		{
+			freeSlots_.push_back(candidate);
+		}
+	}
+
+	//The best victim is taken first
+	std::reverse(freeSlots_.begin(), freeSlots_.end());
+}
+
+void PageCacheController::releaseSlot(SlotIndex slotIndex)
+{
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	PageNumber page = descriptor.page;
+
+	addEviction(descriptor);
+	pageLocator_->set(page, INVALID_SLOT);
+	descriptor.reset();
+	pageReplaceAlgoritm->onPageOperation(slotIndex, PAGE_EVICT, page);
+	freeSlots_.push_back(slotIndex);
+}
+
+void PageCacheController::threadPreCleaner()
+{
+	locker_t locker(synchronizer);
+
+	while (isPreCleanerRun_)
+	{
+		if (!cleanQueue_.empty())
+		{
+			writeBackQueued(locker);
+			continue;
+		}
+
+		//The pool is refilled up to the high-water mark when it falls below the low-water mark
+		if (freeSlots_.size() < lowWaterMark_)
+		{
+			while (isPreCleanerRun_ && freeSlots_.size() < highWaterMark_ && preCleanSlots(locker, highWaterMark_ - freeSlots_.size()) > 0)
+			{
+			}
+
+			if (freeSlots_.size() < lowWaterMark_)
+			{
+				//All candidates are in use now: try again later
+				cvPreCleaner_.wait_for(locker, std::chrono::milliseconds(10));
+				continue;
+			}
+		}
+
+		cvPreCleaner_.wait(locker, [this]()
+		{
+			return !this->isPreCleanerRun_ || this->freeSlots_.size() < this->lowWaterMark_ || !this->cleanQueue_.empty();
+		});
+	}
+}
+
+void PageCacheController::writeBackQueued(locker_t& locker)
+{
+	//The pages stay in the cache clean. A queued slot could have been replaced or taken meanwhile,
+	//so only the dirty pages that nobody uses are written
+	std::vector<SlotIndex> slots;
+	slots.swap(cleanQueue_);
+
+	slots.erase(std::remove_if(slots.begin(), slots.end(), [this](SlotIndex slotIndex)
+	{
+		const PageSlot& descriptor = *this->pageSlotTable_[slotIndex];
+		return descriptor.state != PageSlot::STATE_READY || !descriptor.isDirty || !descriptor.isAvailable() || descriptor.getCaptureCount() != 0;
+	}), slots.end());
+
+	try
+	{
+		flushPages(locker, slots, nullptr, IO_BACKGROUND);
+	}
+	catch (...)
+	{
+		//The pages are dirty again, the flush or their replacement writes them
+	}
+}
+
+size_t PageCacheController::preCleanSlots(locker_t& locker, size_t count)
+{
+	//Only the pages that nobody uses are taken, so the pre-cleaner never waits for the capture.
+	//The free slots go first in the algorithm order, so they are not counted
+	pageReplaceAlgoritm->getReplaceCandidates(cleanerCandidates_, std::min<size_t>(freeSlots_.size() + 64, pageSlotTable_.size()));
+
+	std::vector<SlotIndex> slots;
+	for (PageNumber candidate : cleanerCandidates_)
+	{
+		if (slots.size() == count)
+		{
+			break;
+		}
+
+		if (candidate < pageSlotTable_.size() && pageSlotTable_[candidate]->state == PageSlot::STATE_READY &&
+			pageSlotTable_[candidate]->isAvailable() && pageSlotTable_[candidate]->getCaptureCount() == 0)
+		{
+			slots.push_back(candidate);
+		}
+	}
+
+	//The clean pages are freed at once: the lock is released by the write below
+	std::vector<SlotIndex> dirtySlots;
+	std::vector<StorageRange> ranges;
+
+	for (SlotIndex slotIndex : slots)
+	{
+		PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+		if (!descriptor.isDirty)
+		{
+			releaseSlot(slotIndex);
+			continue;
+		}
+
+		//The threads that need the page wait for the unload as for the replacement
+		descriptor.unloadPage = descriptor.page;
+		descriptor.state = PageSlot::STATE_UNLOAD;
+		dirtySlots.push_back(slotIndex);
+		ranges.push_back({ calcPageAddress(descriptor.unloadPage), pageSize_, calcSlotMemory(slotIndex) });
+	}
+
+	if (dirtySlots.empty())
+	{
+		return slots.size();
+	}
+
+	try
+	{
+		executeWriteV(locker, ranges, nullptr, IO_BACKGROUND);
+	}
+	catch (...)
+	{
+		//The pages stay in the cache, they will be written by the replacement or the flush
+		for (SlotIndex slotIndex : dirtySlots)
+		{
+			PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+			descriptor.state = PageSlot::STATE_READY;
+			descriptor.unloadPage = INVALID_PAGE;
+			descriptor.notifyUnload();
+		}
+		return slots.size() - dirtySlots.size();
+	}
+
+	for (SlotIndex slotIndex : dirtySlots)
+	{
+		PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+		descriptor.isDirty = false;
+		pageLocator_->set(descriptor.unloadPage, INVALID_SLOT);
+		descriptor.notifyUnload();
+		releaseSlot(slotIndex);
+	}
+
+	return slots.size();
+}
+
+void PageCacheController::startStagingWriter()
+{
+	if (!stagedWrites_.empty())
+	{
+		isWriterRun_ = true;
+		stagingWriter_ = std::thread(&PageCacheController::threadStagingWriter, this);
+	}
+}
+
+void PageCacheController::stopStagingWriter()
+{
+	locker_t locker(synchronizer);
+	isWriterRun_ = false;
+	cvStaging_.notify_all();
+	locker.unlock();
+
+	if (stagingWriter_.joinable())
+	{
+		stagingWriter_.join();
+	}
+}
+
+void PageCacheController::threadStagingWriter()
+{
+	locker_t locker(synchronizer);
+
+	while (isWriterRun_)
+	{
+		//All buffers that wait for the storage go as one vector
+		std::vector<size_t> indexes;
+		for (size_t index = 0; index < stagedWrites_.size(); index++)
+		{
+			if (stagedWrites_[index].page != INVALID_PAGE && !stagedWrites_[index].isWriting && !stagedWrites_[index].exception)
+			{
+				indexes.push_back(index);
+			}
+		}
+
+		if (indexes.empty())
+		{
+			cvStaging_.wait(locker);
+			continue;
+		}
+
+		try
+		{
+			writeStaged(locker, indexes, IO_BACKGROUND);
+		}
+		catch (...)
+		{
+			//The data stays in the buffer, the flush tries it again and returns the error
+		}
+	}
+}
+
+bool PageCacheController::stageWrite(PageNumber page, const byte_t* pageData)
+{
+	for (size_t index = 0; index < stagedWrites_.size(); index++)
+	{
+		if (stagedWrites_[index].page == INVALID_PAGE)
+		{
+			::memcpy(&stagingMemory_[index * pageSize_], pageData, pageSize_);
+			stagedWrites_[index].page = page;
+			stagedWriteCount_++;
+
+			cvStaging_.notify_all();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool PageCacheController::isStaged(PageNumber page) const
+{
+	return std::any_of(stagedWrites_.begin(), stagedWrites_.end(), [page](const StagedWrite& staged)
+	{
+		return staged.page == page;
+	});
+}
+
+bool PageCacheController::takeStagedPage(locker_t& locker, PageNumber page, byte_t* pageData)
+{
+	//A page has one buffer at most: it is staged again only after it was loaded back
+	for (size_t index = 0; index < stagedWrites_.size(); index++)
+	{
+		if (stagedWrites_[index].page == page)
+		{
+			//The write that has started is waited for; the pending one is cancelled and the data is taken back
+			cvStaging_.wait(locker, [this, index]()
+			{
+				return !this->stagedWrites_[index].isWriting;
+			});
+
+			if (stagedWrites_[index].page != page)
+			{
+				return false;
+			}
+
+			::memcpy(pageData, &stagingMemory_[index * pageSize_], pageSize_);
+			stagedWrites_[index] = StagedWrite();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void PageCacheController::writeStaged(locker_t& locker, const std::vector<size_t>& indexes, IoPriority priority)
+{
+	std::vector<StorageRange> ranges;
+
+	for (size_t index : indexes)
+	{
+		stagedWrites_[index].isWriting = true;
+		ranges.push_back({ calcPageAddress(stagedWrites_[index].page), pageSize_, &stagingMemory_[index * pageSize_] });
+	}
+
+	try
+	{
+		executeWriteV(locker, ranges, nullptr, priority);
+	}
+	catch (...)
+	{
+		for (size_t index : indexes)
+		{
+			stagedWrites_[index].isWriting = false;
+			stagedWrites_[index].exception = std::current_exception();
+		}
+		cvStaging_.notify_all();
+		std::rethrow_exception(std::current_exception());
+	}
+
+	for (size_t index : indexes)
+	{
+		stagedWrites_[index] = StagedWrite();
+	}
+	cvStaging_.notify_all();
+}
+
+bool PageCacheController::writeStagedPage(locker_t& locker, PageNumber page)
+{
+	for (size_t index = 0; index < stagedWrites_.size(); index++)
+	{
+		if (stagedWrites_[index].page == page)
+		{
+			cvStaging_.wait(locker, [this, index]()
+			{
+				return !this->stagedWrites_[index].isWriting;
+			});
+
+			if (stagedWrites_[index].page == page)
+			{
+				writeStaged(locker, { index }, IO_DEMAND);
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void PageCacheController::flushStagedWrites(locker_t& locker, PageNumber firstPage, PageNumber lastPage)
+{
+	cvStaging_.wait(locker, [this]()
+	{
+		return std::none_of(this->stagedWrites_.begin(), this->stagedWrites_.end(), [](const StagedWrite& staged)
+		{
+			return staged.isWriting;
+		});
+	});
+
+	std::vector<size_t> indexes;
+
+	for (size_t index = 0; index < stagedWrites_.size(); index++)
+	{
+		PageNumber page = stagedWrites_[index].page;
+
+		if (page != INVALID_PAGE && page >= firstPage && page <= lastPage)
+		{
+			indexes.push_back(index);
+		}
+	}
+
+	if (!indexes.empty())
+	{
+		writeStaged(locker, indexes, IO_DEMAND);
+	}
+}
+
+SlotIndex PageCacheController::findCleanCandidate(SlotIndex victim)
+{
+	//A dirty victim costs a write before the read: a clean candidate wins if it is less than 'bias' positions behind
+	pageReplaceAlgoritm->getReplaceCandidates(replaceCandidates_, std::min(cleanFirstCount_, pageSlotTable_.size()));
+
+	SlotIndex bestSlot = victim;
+	size_t bestScore = cleanFirstBias_;
+
+	for (size_t rank = 0; rank < replaceCandidates_.size() && rank < bestScore; rank++)
+	{
+		SlotIndex candidate = replaceCandidates_[rank];
+
+		if (candidate < pageSlotTable_.size() && !pageSlotTable_[candidate]->isDirty && pageSlotTable_[candidate]->isAvailable())
+		{
+			bestSlot = candidate;
+			bestScore = rank;
+		}
+	}
+
+	//The dirty candidates ahead of the clean one are written back by the pre-cleaner, so they are clean when their turn comes
+	if (bestSlot != victim)
+	{
+		for (size_t rank = 0; rank < bestScore; rank++)
+		{
+			SlotIndex candidate = replaceCandidates_[rank];
+
+			if (candidate < pageSlotTable_.size() && pageSlotTable_[candidate]->isDirty)
+			{
+				cleanFirstSkipCount_++;
+
+				if (cleanQueue_.size() < cleanFirstCount_ && std::find(cleanQueue_.begin(), cleanQueue_.end(), candidate) == cleanQueue_.end())
+				{
+					cleanQueue_.push_back(candidate);
+				}
+			}
+		}
+
+		if (!cleanQueue_.empty())
+		{
+			cvPreCleaner_.notify_one();
+		}
+	}
+
+	return bestSlot;
+}
+
+SlotIndex PageCacheController::findReplaceCandidate()
+{
+	//The victim is busy: the other candidates of the algorithm are tried, then any slot that can be replaced.
+	//The number of busy slots is limited by the number of threads, so a short list of candidates is enough
+	const size_t maxCandidates = 64;
+	pageReplaceAlgoritm->getReplaceCandidates(replaceCandidates_, std::min(maxCandidates, pageSlotTable_.size()));
+
+	for (PageNumber candidate : replaceCandidates_)
+	{
+		if (candidate < pageSlotTable_.size() && pageSlotTable_[candidate]->isAvailable())
+		{
+			return candidate;
+		}
+	}
+
+	//Last resort: a scan of all slots, O(slot count) under the lock. It runs only when all candidates are busy,
+	//that is when nearly as many threads as candidates are in the cache at once or the cache is smaller than the list
+	SlotIndex startSlot = replaceCandidates_.empty() ? 0 : replaceCandidates_.back();
+	for (SlotIndex i = 1; i <= pageSlotTable_.size(); i++)
+	{
+		SlotIndex slotIndex = (startSlot + i) % pageSlotTable_.size();
+		if (pageSlotTable_[slotIndex]->isAvailable())
+		{
+			return slotIndex;
+		}
+	}
+
+	return INVALID_SLOT;
+}
+
+void PageCacheController::replacePage(SlotIndex slotIndex, PageNumber newPage, PageOperation pageOperation, locker_t& locker, void* metaData)
+{
+	prepareSlot(slotIndex, newPage, pageOperation, locker, metaData);
+	loadPage(slotIndex, pageOperation, locker, metaData);
+}
+
+void PageCacheController::prepareSlot(SlotIndex slotIndex, PageNumber newPage, PageOperation pageOperation, locker_t& locker, void* metaData)
+{
+	TRACE_POINT(TRACE_REPLACE);
+
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	pageLocator_->set(newPage, slotIndex);
+
+	pageReplaceAlgoritm->onPageOperation(slotIndex, PAGE_REPLACE, newPage);
+
+	try
+	{
+		if (descriptor.state != PageSlot::STATE_FREE)
+		{
+			addEviction(descriptor);
+			descriptor.unloadPage = descriptor.page;
+			descriptor.state = PageSlot::STATE_UNLOAD;
+
+			descriptor.waitCaptureFree(locker);
+
+			unloadPage(slotIndex, pageOperation, locker, metaData);
+
+		}
+
+	}
+	catch (...)
+	{
+		pageLocator_->set(newPage, INVALID_SLOT);
+		descriptor.notifyException(std::current_exception());
+		std::rethrow_exception(std::current_exception());
+	}
+
+	descriptor.unloadPage = INVALID_PAGE;
+	descriptor.state = PageSlot::STATE_LOAD;
+	descriptor.page = newPage;
+	descriptor.hitCount = 0;
+	descriptor.isPrefetched = false;
+}
+
+void PageCacheController::unloadPage(SlotIndex slotIndex, PageOperation pageOperation, locker_t& locker, void* metaData)
+{
+	TRACE_POINT(TRACE_UNLOAD);
+
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	if (descriptor.isDirty)
+	{
+		//With a free staging buffer the slot is released at once and the write goes in the background,
+		//otherwise the replacement waits for the write
+		if (!stageWrite(descriptor.unloadPage, calcSlotMemory(slotIndex)))
+		{
+			writebackCount_++;
+
+			try
+			{
+				executeWrite(locker, calcPageAddress(descriptor.unloadPage), pageSize_, calcSlotMemory(slotIndex), metaData);
+			}
+			catch (...)
+			{
+				descriptor.state = PageSlot::STATE_READY;
+				descriptor.unloadPage = INVALID_PAGE;
+				std::rethrow_exception(std::current_exception());
+			}
+		}
+		
+		descriptor.isDirty = false;
+	}
+
+	pageLocator_->set(descriptor.unloadPage, INVALID_SLOT);
+
+	descriptor.notifyUnload();
+}
+
+void PageCacheController::loadPage(SlotIndex slotIndex, PageOperation pageOperation, locker_t& locker, void* metaData)
+{
+	TRACE_POINT(TRACE_LOAD);
+
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	if (isCleanBeforeLoad_)
+	{
+		memset(calcSlotMemory(slotIndex), 0, pageSize_);
+	}
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	bool isStaged = false;
+
+	try
+	{
+		isStaged = takeStagedPage(locker, descriptor.page, calcSlotMemory(slotIndex));
+
+		if (isStaged)
+		{
+			//The page was evicted but is not written yet, so the storage holds the old data
+			descriptor.isDirty = true;
+		}
+		else if (!executeHedgedRead(locker, calcPageAddress(descriptor.page), pageSize_, calcSlotMemory(slotIndex), metaData))
+		{
+			executeRead(locker, calcPageAddress(descriptor.page), pageSize_, calcSlotMemory(slotIndex), metaData);
+		}
+	}
+	catch (...)
+	{
+		failLoad(slotIndex, std::current_exception());
+		std::rethrow_exception(std::current_exception());
+	}
+
+	unsigned long latency = (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+	if (!isStaged)
+	{
+		addLoadLatency(latency);
+	}
+
+	finishLoad(slotIndex, latency);
+}
+
+void PageCacheController::finishLoad(SlotIndex slotIndex, unsigned long latency)
+{
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	AlgoritmParameterValue cost;
+	if (!getCostHint(calcPageAddress(descriptor.page), cost))
+	{
+		cost = (AlgoritmParameterValue)latency;
+	}
+	pageReplaceAlgoritm->onPageCost(slotIndex, cost);
+
+	descriptor.state = PageSlot::STATE_READY;
+	
+	descriptor.notifyLoad();
+}
+
+void PageCacheController::failLoad(SlotIndex slotIndex, std::exception_ptr exception)
+{
+	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+
+	pageLocator_->set(descriptor.page, INVALID_SLOT);
+	descriptor.reset();
+	pageReplaceAlgoritm->onPageOperation(slotIndex, PAGE_RESET);
+	descriptor.notifyException(exception);
+}
+
+void PageCacheController::markCapture(SlotIndex slotIndex, PageOperation pageOperation, void* metaData)
+{
+	pageSlotTable_[slotIndex]->addCapture(); TRACE_POINT(TRACE_ADD_CAPTURE);
+	pageReplaceAlgoritm->onPageOperation(slotIndex, pageOperation, pageSlotTable_[slotIndex]->page);
+}
+
+void PageCacheController::executeWrite(locker_t& locker, DataAddress address, DataSize size, const void* dataBuffer, void* metaData, IoPriority priority)
+{
+	TRACE_POINT(TRACE_WRITE);
+
+	if (schedulerWindow_ > 0)
+	{
+		IoRequest request(true, address, size, (byte_t*)dataBuffer, metaData, priority);
+		scheduleIo(locker, request);
+		return;
+	}
+
+	limitedWrite(locker, address, size, dataBuffer, metaData, priority);
+}
+
+void PageCacheController::executeRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData, IoPriority priority)
+{
+	TRACE_POINT(TRACE_READ);
+
+	if (schedulerWindow_ > 0)
+	{
+		IoRequest request(false, address, size, (byte_t*)dataBuffer, metaData, priority);
+		scheduleIo(locker, request);
+		return;
+	}
+
+	limitedRead(locker, address, size, dataBuffer, metaData, priority);
+}
+
+void PageCacheController::limitedWrite(locker_t& locker, DataAddress address, DataSize size, const void* dataBuffer, void* metaData, IoPriority priority)
+{
+	writeLimiter_->acquire(locker, priority);
+	locker.unlock();
+
+	try
+	{
+		writeStorage(address, size, dataBuffer, metaData);
+	}
+	catch (...)
+	{
+		locker.lock();
+		writeLimiter_->release();
+		std::rethrow_exception(std::current_exception());
+	}
+	
+	locker.lock();
+	writeLimiter_->release();
+}
+
+void PageCacheController::limitedRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData, IoPriority priority)
+{
+	readLimiter_->acquire(locker, priority);
+	locker.unlock();
+
+	try
+	{
+		readStorage(address, size, dataBuffer, metaData);
+	}
+	catch (...)
+	{
+		locker.lock();
+		readLimiter_->release();
+		std::rethrow_exception(std::current_exception());
+	}
+	
+	locker.lock();
+	readLimiter_->release();
+}
+
+void PageCacheController::executeWriteV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority)
+{
+	if (ranges.size() == 1)
+	{
+		executeWrite(locker, ranges[0].address, ranges[0].size, ranges[0].dataBuffer, metaData, priority);
+		return;
+	}
+
+	//A vector is already a batch, it does not wait for the scheduler window
+	TRACE_POINT(TRACE_WRITE);
+	limitedWriteV(locker, ranges, metaData, priority);
+}
+
+void PageCacheController::executeReadV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority)
+{
+	if (ranges.size() == 1)
+	{
+		executeRead(locker, ranges[0].address, ranges[0].size, ranges[0].dataBuffer, metaData, priority);
+		return;
+	}
+
+	TRACE_POINT(TRACE_READ);
+	limitedReadV(locker, ranges, metaData, priority);
+}
+
+void PageCacheController::limitedWriteV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority)
+{
+	if (ranges.size() == 1)
+	{
+		limitedWrite(locker, ranges[0].address, ranges[0].size, ranges[0].dataBuffer, metaData, priority);
+		return;
+	}
+
+	//One storage call takes one place of the limit
+	writeLimiter_->acquire(locker, priority);
+	locker.unlock();
+
+	try
+	{
+		writeStorageV(ranges, metaData);
+	}
+	catch (...)
+	{
+		locker.lock();
+		writeLimiter_->release();
+		std::rethrow_exception(std::current_exception());
+	}
+
+	locker.lock();
+	writeLimiter_->release();
+}
+
+void PageCacheController::limitedReadV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority)
+{
+	if (ranges.size() == 1)
+	{
+		limitedRead(locker, ranges[0].address, ranges[0].size, ranges[0].dataBuffer, metaData, priority);
+		return;
+	}
+
+	readLimiter_->acquire(locker, priority);
+	locker.unlock();
+
+	try
+	{
+		readStorageV(ranges, metaData);
+	}
+	catch (...)
+	{
+		locker.lock();
+		readLimiter_->release();
+		std::rethrow_exception(std::current_exception());
+	}
+
+	locker.lock();
+	readLimiter_->release();
+}
+
+void PageCacheController::scheduleIo(locker_t& locker, IoRequest& request)
+{
+	pendingIo_.push_back(&request);
+
+	if (isIoCollecting_)
+	{
+		//The thread that opened the window does the I/O
+		cvIo_.wait(locker, [&request]()
+		{
+			return request.isDone;
+		});
+	}
+	else
+	{
+		isIoCollecting_ = true;
+
+		Deadline windowEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(schedulerWindow_);
+		while (cvIo_.wait_until(locker, windowEnd) != std::cv_status::timeout)
+		{
+		}
+
+		std::vector<IoRequest*> batch;
+		batch.swap(pendingIo_);
+		isIoCollecting_ = false;
+
+		dispatchIo(locker, batch);
+	}
+
+	if (request.exception)
+	{
+		std::rethrow_exception(request.exception);
+	}
+}
+
+void PageCacheController::dispatchIo(locker_t& locker, std::vector<IoRequest*>& batch)
+{
+	//One sweep over the addresses; the adjacent requests of the same kind and metaData become one range
+	std::sort(batch.begin(), batch.end(), [](const IoRequest* left, const IoRequest* right)
+	{
+		return left->address < right->address || (left->address == right->address && left->isWrite < right->isWrite);
+	});
+
+	std::vector<IoRun> runs;
+
+	for (size_t first = 0; first < batch.size(); )
+	{
+		IoRun run = { first, first + 1, batch[first]->size, batch[first]->priority };
+
+		while (run.last < batch.size() && batch[run.last]->isWrite == batch[first]->isWrite && 
+			batch[run.last]->metaData == batch[first]->metaData &&
+			batch[run.last]->address == batch[first]->address + run.size && 
+			run.size + (DataAddress)batch[run.last]->size <= std::numeric_limits<DataSize>::max())
+		{
+			run.size += batch[run.last]->size;
+			run.priority = std::min(run.priority, batch[run.last]->priority);
+			run.last++;
+		}
+
+		ioMergedCount_ += run.last - run.first - 1;
+		runs.push_back(run);
+		first = run.last;
+	}
+
+	//The reads of the batch go first, the runs of one kind with equal metaData are one storage call
+	std::vector<std::vector<byte_t>> mergeBuffers(runs.size());
+	std::vector<bool> isDispatched(runs.size(), false);
+
+	for (bool isWrite : { false, true })
+	{
+		for (size_t start = 0; start < runs.size(); start++)
+		{
+			if (isDispatched[start] || batch[runs[start].first]->isWrite != isWrite)
+			{
+				continue;
+			}
+
+			void* metaData = batch[runs[start].first]->metaData;
+			std::vector<StorageRange> ranges;
+			std::vector<size_t> members;
+			IoPriority priority = IO_BACKGROUND;
+
+			for (size_t index = start; index < runs.size(); index++)
+			{
+				IoRun& run = runs[index];
+				IoRequest& head = *batch[run.first];
+
+				if (isDispatched[index] || head.isWrite != isWrite || head.metaData != metaData)
+				{
+					continue;
+				}
+
+				byte_t* runBuffer = head.dataBuffer;
+
+				if (run.last - run.first > 1)
+				{
+					mergeBuffers[index].resize(run.size);
+					runBuffer = mergeBuffers[index].data();
+
+					if (isWrite)
+					{
+						for (size_t request = run.first; request < run.last; request++)
+						{
+							::memcpy(&runBuffer[batch[request]->address - head.address], batch[request]->dataBuffer, batch[request]->size);
+						}
+					}
+				}
+
+				priority = std::min(priority, run.priority);
+				ranges.push_back({ head.address, run.size, runBuffer });
+				members.push_back(index);
+				isDispatched[index] = true;
+			}
+
+			std::exception_ptr exception;
+
+			try
+			{
+				if (isWrite)
+				{
+					limitedWriteV(locker, ranges, metaData, priority);
+				}
+				else
+				{
+					limitedReadV(locker, ranges, metaData, priority);
+				}
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+
+			for (size_t index : members)
+			{
+				IoRun& run = runs[index];
+				IoRequest& head = *batch[run.first];
+
+				for (size_t member = run.first; member < run.last; member++)
+				{
+					IoRequest& request = *batch[member];
+
+					if (!exception && !isWrite && !mergeBuffers[index].empty())
+					{
+						::memcpy(request.dataBuffer, &mergeBuffers[index][request.address - head.address], request.size);
+					}
+
+					request.exception = exception;
+					request.isDone = true;
+				}
+			}
+
+			cvIo_.notify_all();
+		}
+	}
+}
+
+void PageCacheController::startLoadAhead(LoadBatch& batch, DataAddress address, DataSize size, void* metaData)
+{
+	if (loadThreads_.empty())
+	{
+		return;
+	}
+
+	locker_t locker(synchronizer);
+
+	//The first page is loaded by the caller. Not more than a half of the cache is loaded ahead,
+	//so the pages are not evicted before they are copied
+	PageAddressIterator pageIterator(pageSize_, startPageOffset_, address, size);
+	pageIterator++;
+
+	for (; pageIterator.isValid() && batch.pendingCount < pageSlotTable_.size() / 2; pageIterator++)
+	{
+		if (pageLocator_->get(pageIterator.getPage()) == INVALID_SLOT)
+		{
+			loadQueue_.push_back({ pageIterator.getPage(), metaData, &batch });
+			batch.pendingCount++;
+		}
+	}
+
+	cvLoader_.notify_all();
+}
+
+void PageCacheController::finishLoadAhead(LoadBatch& batch)
+{
+	locker_t locker(synchronizer);
+
+	if (batch.pendingCount == 0)
+	{
+		return;
+	}
+
+	//The pages the caller has loaded itself are not needed any more; the loads in progress use its metaData
+	loadQueue_.erase(std::remove_if(loadQueue_.begin(), loadQueue_.end(), [&batch](const LoadTask& task)
+	{
+		if (task.batch == &batch)
+		{
+			batch.pendingCount--;
+			return true;
+		}
+		return false;
+	}), loadQueue_.end());
+
+	cvLoader_.wait(locker, [&batch]()
+	{
+		return batch.pendingCount == 0;
+	});
+}
+
+void PageCacheController::threadLoader()
+{
+	locker_t locker(synchronizer);
+
+	while (isLoaderRun_)
+	{
+		if (loadQueue_.empty())
+		{
+			cvLoader_.wait(locker);
+			continue;
+		}
+
+		//The next pages of the same request are taken along, so they go to the storage as one vector
+		std::vector<LoadTask> tasks(1, loadQueue_.front());
+		loadQueue_.pop_front();
+
+		const size_t chunkPages = std::max<size_t>(1, FLUSH_CHUNK_SIZE / pageSize_);
+		while (!loadQueue_.empty() && tasks.size() < chunkPages && loadQueue_.front().batch == tasks.back().batch &&
+			loadQueue_.front().page == tasks.back().page + 1)
+		{
+			tasks.push_back(loadQueue_.front());
+			loadQueue_.pop_front();
+		}
+
+		try
+		{
+			prefetchPages(tasks, locker);
+		}
+		catch (...)
+		{
+			//A caller that waits for the page gets the exception from the slot, the others load it again
+		}
+
+		tasks.front().batch->pendingCount -= tasks.size();
+		cvLoader_.notify_all();
+	}
+}
+
+void PageCacheController::prefetchPages(const std::vector<LoadTask>& tasks, locker_t& locker)
+{
+	//Nobody has accessed the pages yet: the algorithm gets only the replacement, the first touch of the caller
+	//is its access, as after a miss. The pages loaded by the caller meanwhile are skipped; without a slot
+	//to replace, the caller loads the rest itself
+	void* metaData = tasks.front().metaData;
+	std::vector<SlotIndex> slots;
+
+	try
+	{
+		for (const LoadTask& task : tasks)
+		{
+			if (pageLocator_->get(task.page) != INVALID_SLOT)
+			{
+				continue;
+			}
+
+			SlotIndex slotIndex = selectSlot();
+			if (slotIndex == INVALID_SLOT)
+			{
+				break;
+			}
+
+			missCount_++;
+
+			prepareSlot(slotIndex, task.page, PAGE_READ, locker, metaData);
+			pageSlotTable_[slotIndex]->isPrefetched = true;
+			slots.push_back(slotIndex);
+		}
+	}
+	catch (...)
+	{
+		for (SlotIndex slotIndex : slots)
+		{
+			failLoad(slotIndex, std::current_exception());
+		}
+		std::rethrow_exception(std::current_exception());
+	}
+
+	if (slots.size() == 1)
+	{
+		loadPage(slots.front(), PAGE_READ, locker, metaData);
+		return;
+	}
+
+	//A staged page is taken back at once; the others are read by one vector without hedging,
+	//the latency of the vector is not a sample for the hedged reads
+	std::vector<StorageRange> ranges;
+	std::vector<SlotIndex> readSlots;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+		for (SlotIndex slotIndex : slots)
 		{
-			TRACE_POINT(TRACE_WRITE_PAGE);
-			void* cacheData = calcSlotMemory(slotIndex, pageIterator.getPageOffset());
-			::memcpy(cacheData, pageIterator.getBuffer(), pageIterator.getSize());
-			closePage(slotIndex, PAGE_WRITE, metaData);
+			PageSlot& descriptor = *pageSlotTable_[slotIndex];
 
-			if (writePolicy_ == WRITE_THROUGH)
+			if (isCleanBeforeLoad_)
 			{
-				writeStorage(pageIterator.getAddress(), pageIterator.getSize(), pageIterator.getBuffer(), metaData);
+				memset(calcSlotMemory(slotIndex), 0, pageSize_);
 			}
-		}
-		else
-		{
-			//No free pages
-			writeStorage(pageIterator.getAddress(), pageIterator.getSize(), pageIterator.getBuffer(), metaData);
-		
-		}
 
-		pageIterator++;
-	}
-}
+			if (takeStagedPage(locker, descriptor.page, calcSlotMemory(slotIndex)))
+			{
+				descriptor.isDirty = true;
+				finishLoad(slotIndex, 0);
+				continue;
+			}
 
-void PageCacheController::flush(void* metaData)
-{
-	for (SlotIndex index = 0; index < pageSlotTable_.size(); index++)
-	{
-		locker_t locker(synchronizer);
+			readSlots.push_back(slotIndex);
+			ranges.push_back({ calcPageAddress(descriptor.page), pageSize_, calcSlotMemory(slotIndex) });
+		}
 
-		if (pageSlotTable_[index]->canFlush())
+		if (!ranges.empty())
 		{
-			flushPage(locker, index, metaData);
+			executeReadV(locker, ranges, metaData);
 		}
 	}
-}
-
-void PageCacheController::flush(DataAddress address, DataSize size, void* metaData)
-{
-	PageAddressIterator pageIterator(pageSize_, startPageOffset_, address, size);
-
-	while (pageIterator.isValid())
+	catch (...)
 	{
-		locker_t locker(synchronizer);
-		
-		SlotIndex index = pageLocator_->get(pageIterator.getPage());
-		if ( index != INVALID_SLOT)
+		for (SlotIndex slotIndex : slots)
 		{
-			if (pageSlotTable_[index]->canFlush())
+			if (pageSlotTable_[slotIndex]->state == PageSlot::STATE_LOAD)
 			{
-				flushPage(locker, index, metaData);
+				failLoad(slotIndex, std::current_exception());
 			}
 		}
-		pageIterator++;
+		std::rethrow_exception(std::current_exception());
 	}
-}
 
-void PageCacheController::flushPage(locker_t& locker, SlotIndex slotIndex, void* metaData)
-{
-	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+	unsigned long latency = (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
 
-	try
+	for (SlotIndex slotIndex : readSlots)
 	{
-		descriptor.isDirty = false;
+		finishLoad(slotIndex, latency / (unsigned long)readSlots.size());
+	}
+}
 
-		descriptor.addCapture(); TRACE_POINT(TRACE_ADD_CAPTURE);
-		executeWrite(locker, calcPageAddress(descriptor.page), pageSize_, calcSlotMemory(slotIndex), metaData);
-		descriptor.releaseCapture(); TRACE_POINT(TRACE_RELEASE_CAPTURE);
+void PageCacheController::directWrite(DataAddress address, DataSize size, const void* dataBuffer, void* metaData)
+{
+	locker_t locker(synchronizer);
+	executeWrite(locker, address, size, dataBuffer, metaData);
+}
 
-		pageReplaceAlgoritm->onPageOperation(slotIndex, PAGE_FLUSH);
-	}
-	catch (...)
-	{
-		descriptor.isDirty = true;
-		descriptor.releaseCapture();
-		std::rethrow_exception(std::current_exception());
-	}
+void PageCacheController::directRead(DataAddress address, DataSize size, void* dataBuffer, void* metaData)
+{
+	locker_t locker(synchronizer);
+	executeRead(locker, address, size, dataBuffer, metaData);
 }
 
-void PageCacheController::clear()
+bool PageCacheController::executeHedgedRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData)
 {
-	if (cacheBuffer_ == nullptr)
+	if (!isHedgeRun_ || hedgePercentile_ <= 0 || loadLatencies_.size() < MIN_LATENCY_SAMPLES)
 	{
-		throw cache_exception(ERR_BUFFER_NOT_ALLOCATED);
+		return false;
 	}
 
-	for (auto& descriptor : pageSlotTable_)
-	{
-		descriptor->reset();
-	}
+	//The second read starts when the load is slower than the given percentile of the last loads
+	std::vector<unsigned long> latencies(loadLatencies_);
+	size_t rank = std::min(latencies.size() - 1, (size_t)(latencies.size() * hedgePercentile_ / 100));
+	std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+	Deadline hedgeTime = std::chrono::steady_clock::now() + std::chrono::microseconds(latencies[rank]);
 
-	::memset(cacheBuffer_, 0, pageSlotTable_.size() * pageSize_);
+	TRACE_POINT(TRACE_READ);
 
-	pageReplaceAlgoritm->reset();
+	std::shared_ptr<HedgedLoad> load = std::make_shared<HedgedLoad>();
+	load->buffers[0].resize(size);
+	load->buffers[1].resize(size);
 
-	pageLocator_->clear();
-}
+	auto isFinished = [&load]()
+	{
+		return load->winner >= 0 || load->failCount == load->readerCount;
+	};
 
+	startHedgedReader(load, 0, address, size, metaData);
 
-SlotIndex PageCacheController::openPage(PageNumber pageNumber, PageOperation pageOperation, void* metaData)
-{
-	locker_t locker(synchronizer);
+	if (!cvHedge_.wait_until(locker, hedgeTime, isFinished) && isHedgeRun_)
+	{
+		TRACE_POINT(TRACE_HEDGE);
+		hedgedReadCount_++;
+		load->readerCount++;
+		startHedgedReader(load, 1, address, size, metaData);
+	}
 
-	operationCount_++;
+	cvHedge_.wait(locker, isFinished);
 
-	SlotIndex searchIndex = pageLocator_->get(pageNumber);
-	
-	if (searchIndex == INVALID_SLOT)
+	if (load->winner < 0)
 	{
-		searchIndex = miss(pageNumber, pageOperation, locker, metaData);
+		std::rethrow_exception(load->exception);
 	}
-	else
+
+	if (load->winner == 1)
 	{
-		searchIndex = hit(searchIndex, pageNumber, pageOperation, locker, metaData);
+		hedgedWinCount_++;
 	}
 
-	return searchIndex;
+	::memcpy(dataBuffer, load->buffers[load->winner].data(), size);
+	return true;
 }
 
-void PageCacheController::closePage(SlotIndex slotIndex, PageOperation pageOperation, void* metaData)
-{	
-	locker_t locker(synchronizer);
+void PageCacheController::startHedgedReader(std::shared_ptr<HedgedLoad> load, int reader, DataAddress address, DataSize size, void* metaData)
+{
+	//The loser is not waited for: it finishes in the background and its data is dropped.
+	//A new helper thread is started only when all of them are busy; at the limit the read waits in the queue
+	hedgeQueue_.push_back({ load, reader, address, size, metaData });
 
-	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+	joinRetiredHedgeThreads();
 
-	if (writePolicy_ != WRITE_THROUGH && pageOperation == PAGE_WRITE)
+	if (hedgeQueue_.size() > idleHedgeThreads_ && hedgeThreads_.size() < HEDGE_THREADS_MAX)
 	{
-		descriptor.isDirty = true;
+		hedgeThreads_.push_back(std::thread(&PageCacheController::threadHedgeReader, this));
 	}
 
-	descriptor.releaseCapture(); TRACE_POINT(TRACE_RELEASE_CAPTURE);
+	cvHedge_.notify_all();
 }
 
-SlotIndex PageCacheController::hit(SlotIndex slotIndex, PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData)
+void PageCacheController::threadHedgeReader()
 {
-	TRACE_POINT(TRACE_HIT);
-
-	hitCount_++;
-
-	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+	locker_t locker(synchronizer);
 
-	if (descriptor.isPageUnload(pageNumber)) 
+	//The queued reads are done before the thread stops, somebody waits for them
+	while (isHedgeRun_ || !hedgeQueue_.empty())
 	{
-		TRACE_POINT(TRACE_WAIT_UNLOAD);
-
-		descriptor.waitUnload(locker);
-
-		SlotIndex index = pageLocator_->get(pageNumber);
-
-		if (index != INVALID_SLOT) //another thread could have already located this page
-		{
-			slotIndex = hit(index, pageNumber, pageOperation, locker, metaData);
-			//We have to repeat a hit, because the page can be in waiting state
-		}
-		else
+		if (hedgeQueue_.empty())
 		{
-			slotIndex = miss(pageNumber, pageOperation, locker, metaData);
-		}
-	}
-	else
-	{
-		TRACE_POINT(TRACE_WAIT_LOAD);
+			idleHedgeThreads_++;
+			bool isWoken = cvHedge_.wait_for(locker, std::chrono::milliseconds(HEDGE_IDLE_MILLISECONDS), [this]()
+			{
+				return !this->isHedgeRun_ || !this->hedgeQueue_.empty();
+			});
+			idleHedgeThreads_--;
 
-		if (descriptor.isLoading())
-		{
-			descriptor.waitLoad(locker);
+			if (!isWoken)
+			{
+				retiredHedgeThreads_.push_back(std::this_thread::get_id());
+				return;
+			}
+			continue;
 		}
 
-		markCapture(slotIndex, pageOperation, metaData);
-	}
+		HedgedRead task = hedgeQueue_.front();
+		hedgeQueue_.pop_front();
 
-	return slotIndex;
+		runHedgedRead(locker, task);
+	}
 }
 
-
-SlotIndex PageCacheController::miss(PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData)
+void PageCacheController::runHedgedRead(locker_t& locker, HedgedRead& task)
 {
-	TRACE_POINT(TRACE_MISS);
-
-	missCount_++;
-
-	if (writeMissPolicy_ == WRITE_AROUND && pageOperation == PAGE_WRITE)
-	{
-		return INVALID_SLOT;
-	}
+	HedgedLoad& load = *task.load;
+	std::exception_ptr exception;
 
-	SlotIndex searchSlot = pageReplaceAlgoritm->getReplacePage();
+	readLimiter_->acquire(locker, IO_DEMAND);
+	locker.unlock();
 
-	if (searchSlot != INVALID_SLOT)
+	try
 	{
-		PageSlot& descriptor = *pageSlotTable_[searchSlot];
-		if (descriptor.isAvailable())
+		if (task.reader == 0)
 		{
-			replacePage(searchSlot, pageNumber, pageOperation, locker, metaData);
-			markCapture(searchSlot, pageOperation, metaData);
+			readStorage(task.address, task.size, load.buffers[task.reader].data(), task.metaData);
 		}
 		else
 		{
-			//It might occure that all pages are in replace state
-			directCount_++;
-			searchSlot = INVALID_SLOT;
+			readStorageHedged(task.address, task.size, load.buffers[task.reader].data(), task.metaData);
 		}
 	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
 
-	return searchSlot;
-}
-
-void PageCacheController::replacePage(SlotIndex slotIndex, PageNumber newPage, PageOperation pageOperation, locker_t& locker, void* metaData)
-{
-	TRACE_POINT(TRACE_REPLACE);
-
-	PageSlot& descriptor = *pageSlotTable_[slotIndex];
-
-	pageLocator_->set(newPage, slotIndex);
-
-	pageReplaceAlgoritm->onPageOperation(slotIndex, PAGE_REPLACE);
+	locker.lock();
+	readLimiter_->release();
 
-	try
+	if (exception)
 	{
-		if (descriptor.state != PageSlot::STATE_FREE)
+		load.failCount++;
+		if (!load.exception)
 		{
-			descriptor.unloadPage = descriptor.page;
-			descriptor.state = PageSlot::STATE_UNLOAD;
-
-			descriptor.waitCaptureFree(locker);
-
-			unloadPage(slotIndex, pageOperation, locker, metaData);
-
+			load.exception = exception;
 		}
-
-		descriptor.unloadPage = INVALID_PAGE;
-		descriptor.state = PageSlot::STATE_LOAD;
-		descriptor.page = newPage;
-
-		loadPage(slotIndex, pageOperation, locker, metaData);
 	}
-	catch (...)
+	else if (load.winner < 0)
 	{
-		pageLocator_->set(newPage, INVALID_SLOT);
-		descriptor.notifyException(std::current_exception());
-		std::rethrow_exception(std::current_exception());
+		load.winner = task.reader;
 	}
+
+	cvHedge_.notify_all();
 }
 
-void PageCacheController::unloadPage(SlotIndex slotIndex, PageOperation pageOperation, locker_t& locker, void* metaData)
+bool PageCacheController::checkBypass(DataAddress address, DataSize size)
 {
-	TRACE_POINT(TRACE_UNLOAD);
+	std::lock_guard<std::mutex> lock(synchronizer);
 
-	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+	bool isBypass = bypassThreshold_ > 0 && size >= bypassThreshold_;
 
-	if (descriptor.isDirty)
+	//A request over several pages that starts where an earlier request ended continues a stream. When most
+	//of the evicted pages have never been hit, the streams go around the cache, so they do not push out
+	//the pages that are used again
+	if (!isBypass && bypassZeroHitRatio_ > 0 && continueStream(address, size) &&
+		evictionSamples_.size() == EVICTION_SAMPLES && zeroHitEvictions_ >= bypassZeroHitRatio_ * EVICTION_SAMPLES)
 	{
-		try
-		{
-			executeWrite(locker, calcPageAddress(descriptor.unloadPage), pageSize_, calcSlotMemory(slotIndex), metaData);
-		}
-		catch (...)
+		PageAddressIterator pageIterator(pageSize_, startPageOffset_, address, size);
+
+		if (pageIterator.isValid())
 		{
-			descriptor.state = PageSlot::STATE_READY;
-			descriptor.unloadPage = INVALID_PAGE;
-			std::rethrow_exception(std::current_exception());
+			pageIterator++;
+			isBypass = pageIterator.isValid() && ++bypassProbe_ % BYPASS_PROBE_INTERVAL != 0;
 		}
-		
-		descriptor.isDirty = false;
 	}
 
-	pageLocator_->set(descriptor.unloadPage, INVALID_SLOT);
+	if (isBypass)
+	{
+		bypassCount_++;
+	}
 
-	descriptor.notifyUnload();
+	return isBypass;
 }
 
-void PageCacheController::loadPage(SlotIndex slotIndex, PageOperation pageOperation, locker_t& locker, void* metaData)
+bool PageCacheController::continueStream(DataAddress address, DataSize size)
 {
-	TRACE_POINT(TRACE_LOAD);
+	if (size == 0)
+	{
+		return false;
+	}
 
-	PageSlot& descriptor = *pageSlotTable_[slotIndex];
+	//The end of the request replaces the stream end it continues, or the oldest one
+	auto stream = std::find(streamEnds_.begin(), streamEnds_.end(), address);
+	bool isStream = stream != streamEnds_.end();
 
-	if (isCleanBeforeLoad_)
+	if (isStream)
 	{
-		memset(calcSlotMemory(slotIndex), 0, pageSize_);
+		*stream = address + size;
 	}
-
-	try
+	else if (streamEnds_.size() < STREAM_SLOTS)
 	{
-		executeRead(locker, calcPageAddress(descriptor.page), pageSize_, calcSlotMemory(slotIndex), metaData);
+		streamEnds_.push_back(address + size);
 	}
-	catch (...)
+	else
 	{
-		descriptor.reset();
-		pageReplaceAlgoritm->onPageOperation(slotIndex, PAGE_RESET);
-		std::rethrow_exception(std::current_exception());
+		streamEnds_[nextStream_] = address + size;
+		nextStream_ = (nextStream_ + 1) % STREAM_SLOTS;
 	}
 
-	descriptor.state = PageSlot::STATE_READY;
-	
-	descriptor.notifyLoad();
+	return isStream;
 }
 
-void PageCacheController::markCapture(SlotIndex slotIndex, PageOperation pageOperation, void* metaData)
+void PageCacheController::addBypassBytes(DataSize bytes)
 {
-	pageSlotTable_[slotIndex]->addCapture(); TRACE_POINT(TRACE_ADD_CAPTURE);
-	pageReplaceAlgoritm->onPageOperation(slotIndex, pageOperation);
+	std::lock_guard<std::mutex> lock(synchronizer);
+	bypassBytes_ += bytes;
 }
 
-void PageCacheController::executeWrite(locker_t& locker, DataAddress address, DataSize size, const void* dataBuffer, void* metaData)
+void PageCacheController::addEviction(const PageSlot& descriptor)
 {
-	TRACE_POINT(TRACE_WRITE);
-	locker.unlock();
+	if (bypassZeroHitRatio_ <= 0)
+	{
+		return;
+	}
 
-	try
+	bool isZeroHit = descriptor.hitCount == 0;
+
+	if (evictionSamples_.size() < EVICTION_SAMPLES)
 	{
-		writeStorage(address, size, dataBuffer, metaData);
+		evictionSamples_.push_back(isZeroHit);
 	}
-	catch (...)
+	else
 	{
-		locker.lock();
-		std::rethrow_exception(std::current_exception());
+		zeroHitEvictions_ -= evictionSamples_[nextEviction_];
+		evictionSamples_[nextEviction_] = isZeroHit;
+		nextEviction_ = (nextEviction_ + 1) % EVICTION_SAMPLES;
 	}
-	
-	locker.lock();
+
+	zeroHitEvictions_ += isZeroHit;
 }
 
-void PageCacheController::executeRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData)
+void PageCacheController::addLoadLatency(unsigned long latency)
 {
-	TRACE_POINT(TRACE_READ);
-	locker.unlock();
+	if (hedgePercentile_ <= 0)
+	{
+		return;
+	}
 
-	try
+	if (loadLatencies_.size() < LATENCY_SAMPLES)
 	{
-		readStorage(address, size, dataBuffer, metaData);
+		loadLatencies_.push_back(latency);
 	}
-	catch (const std::exception&)
+	else
 	{
-		locker.lock();
-		std::rethrow_exception(std::current_exception());
+		loadLatencies_[nextLatency_] = latency;
+		nextLatency_ = (nextLatency_ + 1) % LATENCY_SAMPLES;
 	}
-	
-	locker.lock();
 }
 
-
 PageCacheController::byte_t* PageCacheController::calcSlotMemory(SlotIndex slotIndex, PageOffset offset)
 {
 	return &cacheBuffer_[slotIndex * pageSize_ + offset];
@@ -501,22 +2242,79 @@ void PageCacheController::setWriteMissPolicy(WriteMissPolicy policy)
 	writeMissPolicy_ = policy;
 }
 
+void PageCacheController::setReadMissPolicy(ReadMissPolicy policy)
+{
+	readMissPolicy_ = policy;
+}
+
+void PageCacheController::setDeadlinePolicy(DeadlinePolicy policy)
+{
+	deadlinePolicy_ = policy;
+}
+
 void PageCacheController::setReplaceAlgoritm(ReplaceAlgoritm algoritm)
 {
+	//The background threads and the readers use the algorithm under the lock
+	std::lock_guard<std::mutex> lock(synchronizer);
 	pageReplaceAlgoritm.reset(CacheAlgorithm::create(algoritm));
 	pageReplaceAlgoritm->setPageCount(pageSlotTable_.size());
 }
 
 void PageCacheController::setAlgoritmParameter(const char* paramName, AlgoritmParameterValue paramValue)
 {
+	std::lock_guard<std::mutex> lock(synchronizer);
 	pageReplaceAlgoritm->setParameter(paramName, paramValue);
 }
 
 AlgoritmParameterValue PageCacheController::getAlgoritmParameter(const char* paramName) const
 {
+	std::lock_guard<std::mutex> lock(synchronizer);
 	return pageReplaceAlgoritm->getParameter(paramName);
 }
 
+void PageCacheController::setCostHint(DataAddress address, DataSize size, AlgoritmParameterValue cost)
+{
+	std::lock_guard<std::mutex> lock(synchronizer);
+
+	//The hint of an address is the range that starts nearest below it, so the ranges must not overlap.
+	//The cost of an existing range can be changed
+	auto next = costHints_.lower_bound(address);
+	if (next == costHints_.end() || next->first != address || next->second.first != address + size)
+	{
+		if (size == 0 || (next != costHints_.end() && next->first < address + size) ||
+			(next != costHints_.begin() && std::prev(next)->second.first > address))
+		{
+			throw cache_exception(ERR_PARAMETER_VALUE);
+		}
+	}
+
+	costHints_[address] = CostRange(address + size, cost);
+}
+
+void PageCacheController::clearCostHints()
+{
+	std::lock_guard<std::mutex> lock(synchronizer);
+	costHints_.clear();
+}
+
+bool PageCacheController::getCostHint(DataAddress address, AlgoritmParameterValue& cost) const
+{
+	auto range = costHints_.upper_bound(address);
+	if (range == costHints_.begin())
+	{
+		return false;
+	}
+
+	range--;
+	if (address >= range->second.first)
+	{
+		return false;
+	}
+
+	cost = range->second.second;
+	return true;
+}
+
 void PageCacheController::setLocatorType(LocatorType type)
 {
 	pageLocator_->setType(type);
@@ -537,6 +2335,19 @@ CacheStatistic PageCacheController::getStatistic() const
 	statistic.hitCount = hitCount_;
 	statistic.missCount = missCount_;
 	statistic.directCount = directCount_;
+	statistic.writebackCount = writebackCount_;
+	statistic.cleanFirstSkipCount = cleanFirstSkipCount_;
+	statistic.stagedWriteCount = stagedWriteCount_;
+	statistic.timeoutCount = timeoutCount_;
+	statistic.hedgedReadCount = hedgedReadCount_;
+	statistic.hedgedWinCount = hedgedWinCount_;
+	statistic.ioQueuedCount = readLimiter_->getQueuedCount() + writeLimiter_->getQueuedCount();
+	statistic.ioWaitTime = readLimiter_->getWaitTime() + writeLimiter_->getWaitTime();
+	statistic.ioQueueDepth = (unsigned long)(readLimiter_->getQueueDepth() + writeLimiter_->getQueueDepth());
+	statistic.ioMaxQueueDepth = (unsigned long)std::max(readLimiter_->getMaxQueueDepth(), writeLimiter_->getMaxQueueDepth());
+	statistic.ioMergedCount = ioMergedCount_;
+	statistic.bypassCount = bypassCount_;
+	statistic.bypassBytes = bypassBytes_;
 	statistic.locatorMemory = pageLocator_->getMemorySize();
 
 	return statistic;
@@ -550,6 +2361,17 @@ void PageCacheController::resetStatistic()
 	hitCount_ = 0;
 	missCount_ = 0;
 	directCount_ = 0;
+	writebackCount_ = 0;
+	cleanFirstSkipCount_ = 0;
+	stagedWriteCount_ = 0;
+	timeoutCount_ = 0;
+	hedgedReadCount_ = 0;
+	hedgedWinCount_ = 0;
+	ioMergedCount_ = 0;
+	bypassCount_ = 0;
+	bypassBytes_ = 0;
+	readLimiter_->resetStatistic();
+	writeLimiter_->resetStatistic();
 }
 
 CacheSettings PageCacheController::getSettings() const
@@ -560,11 +2382,26 @@ CacheSettings PageCacheController::getSettings() const
 	settings.pageSize = pageSize_;
 	settings.writePolicy = writePolicy_;
 	settings.writeMissPolicy = writeMissPolicy_;
+	settings.readMissPolicy = readMissPolicy_;
 	settings.replaceAlgoritm = pageReplaceAlgoritm->getType();
 	settings.locatorType = pageLocator_->getType();
 	settings.isEnabled = isEnabled_;
 	settings.isCleanBeforeLoad = isCleanBeforeLoad_;
 	settings.hashMemoryLimit = pageLocator_->getHashMemoryLimit();
+	settings.reclaimBatch = reclaimBatch_;
+	settings.cleanFirstCount = cleanFirstCount_;
+	settings.cleanFirstBias = cleanFirstBias_;
+	settings.freePoolLowWater = lowWaterMark_;
+	settings.freePoolHighWater = highWaterMark_;
+	settings.writebackBuffers = stagedWrites_.size();
+	settings.deadlinePolicy = deadlinePolicy_;
+	settings.hedgePercentile = hedgePercentile_;
+	settings.readLimit = readLimiter_->getLimit();
+	settings.writeLimit = writeLimiter_->getLimit();
+	settings.schedulerWindow = schedulerWindow_;
+	settings.loadThreads = loadThreads_.size();
+	settings.bypassThreshold = bypassThreshold_;
+	settings.bypassZeroHitRatio = bypassZeroHitRatio_;
 
 	return settings;
 }
@@ -646,6 +2483,22 @@ void PageCacheController::setDebugLogEndline(bool isInsertEndline)
 	isInsertEndline_ = isInsertEndline;
 }
 
+void PageCacheController::readStorageV(const std::vector<StorageRange>& ranges, void* metaData)
+{
+	for (const StorageRange& range : ranges)
+	{
+		readStorage(range.address, range.size, range.dataBuffer, metaData);
+	}
+}
+
+void PageCacheController::writeStorageV(const std::vector<StorageRange>& ranges, void* metaData)
+{
+	for (const StorageRange& range : ranges)
+	{
+		writeStorage(range.address, range.size, range.dataBuffer, metaData);
+	}
+}
+
 void PageCacheController::log(const char* strFormat, ...)
 {
 	//Don't call this method directly, use a macro LOG instead
@@ -3,8 +3,14 @@
 #include "CacheTypes.h"
 
 #include <vector>
+#include <map>
 #include <limits>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <deque>
 
 namespace cache
 {
@@ -13,6 +19,7 @@ namespace cache
 	class CacheAlgorithm;
 	class PageSlot;
 	class PageLocator;
+	class IoLimiter;
 
 	class PageCacheController
 	{
@@ -25,22 +32,44 @@ namespace cache
 
 		void read(DataAddress address, DataSize size, void* readBuffer, void* metaData = nullptr);
 		void write(DataAddress address, DataSize size, const void* writeBuffer, void* metaData = nullptr);
+		bool read(DataAddress address, DataSize size, void* readBuffer, const Deadline& deadline, void* metaData = nullptr);
+		bool write(DataAddress address, DataSize size, const void* writeBuffer, const Deadline& deadline, void* metaData = nullptr);
+		void read(DataAddress address, DataSize size, void* readBuffer, ReadMissPolicy policy, void* metaData = nullptr);
+		bool read(DataAddress address, DataSize size, void* readBuffer, const Deadline& deadline, ReadMissPolicy policy, void* metaData = nullptr);
 		void flush(void* metaData = nullptr);
 		void flush(DataAddress address, DataSize size, void* metaData = nullptr);
 		void clear();
 
+		//Switches off the loaders, the pre-cleaner, the writeback buffers and the hedged reads. Their threads call
+		//the storage methods, so the destructor of the derived class must call it
+		void shutdown();
+
 		void enable(bool isEnable);
 		void setCleanBeforeLoad(bool isCleanBeforeLoad);
+		void setReclaimBatch(size_t batchSize);
+		void setCleanFirst(size_t candidateCount, size_t dirtyBias);
+		void setFreePool(size_t lowWaterMark, size_t highWaterMark);
+		void setWritebackBuffers(size_t bufferCount);
+		void setHedgedRead(double percentile);
+		void setIoLimit(size_t readLimit, size_t writeLimit);
+		void setIoScheduler(unsigned long windowMicroseconds);
+		void setLoadThreads(size_t threadCount);
+		void setBypass(DataSize sizeThreshold, double zeroHitRatio);
 
 		void setReplaceAlgoritm(ReplaceAlgoritm algoritm);
 		void setAlgoritmParameter(const char* paramName, AlgoritmParameterValue paramValue);
 		AlgoritmParameterValue getAlgoritmParameter(const char* paramName) const;
 
+		void setCostHint(DataAddress address, DataSize size, AlgoritmParameterValue cost);
+		void clearCostHints();
+
 		void setLocatorType(LocatorType type);
 		void setLimitHashMemory(size_t memoryLimit);
 
 		void setWritePolicy(WritePolicy policy);
 		void setWriteMissPolicy(WriteMissPolicy policy);
+		void setReadMissPolicy(ReadMissPolicy policy);
+		void setDeadlinePolicy(DeadlinePolicy policy);
 
 		CacheStatistic getStatistic() const;
 		void resetStatistic();
@@ -55,6 +84,12 @@ namespace cache
 	protected:
 		virtual void readStorage(DataAddress address, DataSize size, void* dataBuffer, void* metaData) {}
 		virtual void writeStorage(DataAddress address, DataSize size, const void* dataBuffer, void* metaData) {}
+		virtual void readStorageHedged(DataAddress address, DataSize size, void* dataBuffer, void* metaData) 
+		{ 
+			readStorage(address, size, dataBuffer, metaData); 
+		}
+		virtual void readStorageV(const std::vector<StorageRange>& ranges, void* metaData);
+		virtual void writeStorageV(const std::vector<StorageRange>& ranges, void* metaData);
 
 	private:
 		typedef unsigned char byte_t;
@@ -67,14 +102,131 @@ namespace cache
 		bool isInsertEndline_ = false;
 		WritePolicy writePolicy_ = WRITE_BACK;
 		WriteMissPolicy writeMissPolicy_ = WRITE_ALLOCATE;
+		ReadMissPolicy readMissPolicy_ = READ_ALLOCATE;
+		DeadlinePolicy deadlinePolicy_ = DEADLINE_TIMEOUT;
 
 		std::vector<std::unique_ptr<PageSlot>> pageSlotTable_;
 		std::unique_ptr<PageLocator> pageLocator_;
 		std::unique_ptr<CacheAlgorithm> pageReplaceAlgoritm;
+		std::unique_ptr<IoLimiter> readLimiter_;
+		std::unique_ptr<IoLimiter> writeLimiter_;
+		std::vector<PageNumber> replaceCandidates_;
+		std::vector<SlotIndex> freeSlots_;	//slots released by the batch reclaim
+		size_t reclaimBatch_ = 0;
+		size_t cleanFirstCount_ = 0;
+		size_t cleanFirstBias_ = 0;
+
+		size_t lowWaterMark_ = 0;
+		size_t highWaterMark_ = 0;
+		bool isPreCleanerRun_ = false;
+		std::thread preCleaner_;
+		std::condition_variable cvPreCleaner_;
+		std::vector<PageNumber> cleanerCandidates_;
+		std::vector<SlotIndex> cleanQueue_;	//dirty candidates passed over by the clean-first policy, the pre-cleaner writes them back
+
+		struct StagedWrite
+		{
+			PageNumber page = INVALID_PAGE;	//INVALID_PAGE: the buffer is free
+			bool isWriting = false;
+			std::exception_ptr exception;	//the last write failed, the data waits for the flush
+		};
+
+		std::vector<StagedWrite> stagedWrites_;
+		std::vector<byte_t> stagingMemory_;
+		bool isWriterRun_ = false;
+		std::thread stagingWriter_;
+		std::condition_variable cvStaging_;
+
+		struct HedgedLoad
+		{
+			std::vector<byte_t> buffers[2];	//the first read and the hedged one
+			int winner = -1;
+			int readerCount = 1;
+			int failCount = 0;
+			std::exception_ptr exception;
+		};
+
+		double hedgePercentile_ = 0;
+		std::vector<unsigned long> loadLatencies_;	//microseconds, the last loads
+		size_t nextLatency_ = 0;
+		struct HedgedRead
+		{
+			std::shared_ptr<HedgedLoad> load;
+			int reader;
+			DataAddress address;
+			DataSize size;
+			void* metaData;
+		};
+
+		std::vector<std::thread> hedgeThreads_;	//started on demand, an idle thread retires after a while
+		std::vector<std::thread::id> retiredHedgeThreads_;	//have returned, joined by the next start
+		std::deque<HedgedRead> hedgeQueue_;
+		size_t idleHedgeThreads_ = 0;
+		bool isHedgeRun_ = false;
+		std::condition_variable cvHedge_;
+
+		struct IoRequest
+		{
+			IoRequest(bool isWrite, DataAddress address, DataSize size, byte_t* dataBuffer, void* metaData, IoPriority priority) :
+				isWrite(isWrite), address(address), size(size), dataBuffer(dataBuffer), metaData(metaData), priority(priority)
+			{
+			}
+
+			bool isWrite;
+			DataAddress address;
+			DataSize size;
+			byte_t* dataBuffer;		//the read buffer or the data to write
+			void* metaData;
+			IoPriority priority;
+			bool isDone = false;
+			std::exception_ptr exception;
+		};
+
+		struct IoRun
+		{
+			size_t first;			//the requests [first, last) of the sorted batch
+			size_t last;
+			DataSize size;
+			IoPriority priority;
+		};
+
+		unsigned long schedulerWindow_ = 0;	//microseconds, 0 - the scheduler is off
+		bool isIoCollecting_ = false;
+		std::vector<IoRequest*> pendingIo_;
+		std::condition_variable cvIo_;
+
+		struct LoadBatch
+		{
+			size_t pendingCount = 0;	//the pages of one request that are queued or loading
+		};
+
+		struct LoadTask
+		{
+			PageNumber page;
+			void* metaData;
+			LoadBatch* batch;
+		};
+
+		std::vector<std::thread> loadThreads_;
+		std::deque<LoadTask> loadQueue_;
+		bool isLoaderRun_ = false;
+		std::condition_variable cvLoader_;
+
+		DataSize bypassThreshold_ = 0;			//0 - the large requests are cached
+		double bypassZeroHitRatio_ = 0;			//0 - the thrash detection is off
+		std::vector<bool> evictionSamples_;		//true - the page was evicted without a hit
+		size_t nextEviction_ = 0;
+		size_t zeroHitEvictions_ = 0;
+		unsigned long bypassProbe_ = 0;
+		std::vector<DataAddress> streamEnds_;	//the end addresses of the last requests, a request that starts at one continues a stream
+		size_t nextStream_ = 0;
 
 		mutable std::mutex  synchronizer;
 		typedef std::unique_lock<std::mutex> locker_t;
 
+		typedef std::pair<DataAddress, AlgoritmParameterValue> CostRange; //end address and cost
+		std::map<DataAddress, CostRange> costHints_;
+
 		CallbackTracePoint callbackTracePoint_;
 		CallbackLog callbackLog_;
 
@@ -82,20 +234,82 @@ namespace cache
 		unsigned long hitCount_ = 0;
 		unsigned long missCount_ = 0;
 		unsigned long directCount_ = 0;
+		unsigned long writebackCount_ = 0;
+		unsigned long cleanFirstSkipCount_ = 0;
+		unsigned long stagedWriteCount_ = 0;
+		unsigned long timeoutCount_ = 0;
+		unsigned long hedgedReadCount_ = 0;
+		unsigned long hedgedWinCount_ = 0;
+		unsigned long ioMergedCount_ = 0;
+		unsigned long bypassCount_ = 0;
+		unsigned long bypassBytes_ = 0;
 
-		SlotIndex openPage(PageNumber pageNumber, PageOperation pageOperation, void* metaData);
+		SlotIndex openPage(PageNumber pageNumber, PageOperation pageOperation, void* metaData, const Deadline& deadline = Deadline::max(), bool isAround = false);
 		void closePage(SlotIndex slotIndex, PageOperation pageOperation, void* metaData); //metaData
-		SlotIndex hit(SlotIndex slotIndex, PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData);
-		SlotIndex miss(PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData);
+		SlotIndex hit(SlotIndex slotIndex, PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData, const Deadline& deadline, bool isAround);
+		SlotIndex miss(PageNumber pageNumber, PageOperation pageOperation, locker_t& locker, void* metaData, bool isAround = false);
+		SlotIndex selectSlot();
+		SlotIndex findReplaceCandidate();
+		SlotIndex findCleanCandidate(SlotIndex victim);
+		void resetFreeSlots();
+		SlotIndex takeFreeSlot();
+		void reclaimSlots();
+		void releaseSlot(SlotIndex slotIndex);
+		void startPreCleaner();
+		void stopPreCleaner();
+		void threadPreCleaner();
+		void writeBackQueued(locker_t& locker);
+		size_t preCleanSlots(locker_t& locker, size_t count);
+		void startStagingWriter();
+		void stopStagingWriter();
+		void threadStagingWriter();
+		bool stageWrite(PageNumber page, const byte_t* pageData);
+		bool isStaged(PageNumber page) const;
+		bool takeStagedPage(locker_t& locker, PageNumber page, byte_t* pageData);
+		void writeStaged(locker_t& locker, const std::vector<size_t>& indexes, IoPriority priority);
+		bool writeStagedPage(locker_t& locker, PageNumber page);
+		void flushStagedWrites(locker_t& locker, PageNumber firstPage, PageNumber lastPage);
 		void markCapture(SlotIndex slotIndex, PageOperation pageOperation, void* metaData); //metaData
 		void replacePage(SlotIndex slotIndex, PageNumber newPage, PageOperation pageOperation, locker_t& locker, void* metaData); //pageOperation
+		void prepareSlot(SlotIndex slotIndex, PageNumber newPage, PageOperation pageOperation, locker_t& locker, void* metaData);
 		void unloadPage(SlotIndex slotIndex, PageOperation pageOperation, locker_t& locker, void* metaData); //pageOperation
 		void loadPage(SlotIndex slotIndex, PageOperation pageOperation, locker_t& locker, void* metaData); //pageOperation
-		void executeWrite(locker_t& locker, DataAddress address, DataSize size, const void* dataBuffer, void* metaData);
-		void executeRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData);
-		void flushPage(locker_t& locker, SlotIndex slotIndex, void* metaData);
+		void finishLoad(SlotIndex slotIndex, unsigned long latency);
+		void failLoad(SlotIndex slotIndex, std::exception_ptr exception);
+		void executeWrite(locker_t& locker, DataAddress address, DataSize size, const void* dataBuffer, void* metaData, IoPriority priority = IO_DEMAND);
+		void executeRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData, IoPriority priority = IO_DEMAND);
+		void limitedWrite(locker_t& locker, DataAddress address, DataSize size, const void* dataBuffer, void* metaData, IoPriority priority);
+		void limitedRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData, IoPriority priority);
+		void executeWriteV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority = IO_DEMAND);
+		void executeReadV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority = IO_DEMAND);
+		void limitedWriteV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority);
+		void limitedReadV(locker_t& locker, const std::vector<StorageRange>& ranges, void* metaData, IoPriority priority);
+		void scheduleIo(locker_t& locker, IoRequest& request);
+		void dispatchIo(locker_t& locker, std::vector<IoRequest*>& batch);
+		bool readPages(DataAddress address, DataSize size, void* readBuffer, const Deadline& deadline, ReadMissPolicy policy, void* metaData, DataSize& directBytes);
+		bool checkBypass(DataAddress address, DataSize size);
+		bool continueStream(DataAddress address, DataSize size);
+		void addBypassBytes(DataSize bytes);
+		void addEviction(const PageSlot& descriptor);
+		void startLoadAhead(LoadBatch& batch, DataAddress address, DataSize size, void* metaData);
+		void finishLoadAhead(LoadBatch& batch);
+		void startLoadThreads(size_t threadCount);
+		void stopLoadThreads();
+		void threadLoader();
+		void prefetchPages(const std::vector<LoadTask>& tasks, locker_t& locker);
+		void directWrite(DataAddress address, DataSize size, const void* dataBuffer, void* metaData);
+		void directRead(DataAddress address, DataSize size, void* dataBuffer, void* metaData);
+		bool executeHedgedRead(locker_t& locker, DataAddress address, DataSize size, void* dataBuffer, void* metaData);
+		void startHedgedReader(std::shared_ptr<HedgedLoad> load, int reader, DataAddress address, DataSize size, void* metaData);
+		void stopHedgeThreads();
+		void joinRetiredHedgeThreads();
+		void threadHedgeReader();
+		void runHedgedRead(locker_t& locker, HedgedRead& task);
+		void addLoadLatency(unsigned long latency);
+		void flushPages(locker_t& locker, std::vector<SlotIndex>& slots, void* metaData, IoPriority priority = IO_DEMAND);
 		byte_t* calcSlotMemory(SlotIndex slotIndex, PageOffset offset = 0);
 		DataAddress calcPageAddress(PageNumber page);
+		bool getCostHint(DataAddress address, AlgoritmParameterValue& cost) const;
 
 		void log(const char* strFormat, ...);
 	};
@@ -10,8 +10,9 @@ PageSlot::PageSlot()
 	page = INVALID_PAGE;
 	unloadPage = INVALID_PAGE;
 	isDirty = false;
-	int capturedNumber = 0;
-	int waitingNumber = 0;
+	hitCount = 0;
+	capturedNumber_ = 0;
+	waitingNumber_ = 0;
 }
 
 void PageSlot::reset()
@@ -20,6 +21,8 @@ void PageSlot::reset()
 	page = INVALID_PAGE;
 	unloadPage = INVALID_PAGE;
 	isDirty = false;
+	hitCount = 0;
+	isPrefetched = false;
 }
 
 bool PageSlot::isAvailable() const
@@ -77,38 +80,64 @@ void PageSlot::waitCaptureFree(locker_t& locker)
 }
 
 void PageSlot::waitUnload(locker_t& locker)
+{
+	waitUnload(locker, Deadline::max());
+}
+
+void PageSlot::waitLoad(locker_t& locker)
+{
+	waitLoad(locker, Deadline::max());
+}
+
+bool PageSlot::waitUnload(locker_t& locker, const Deadline& deadline)
 {
 	waitingNumber_++;
 
-	cvUnload_.wait(locker,[this]() 
+	auto isUnloaded = [this]()
 	{
 		return this->state != PageSlot::STATE_UNLOAD;
-	});
-
-	waitingNumber_--;
+	};
 
-	std::exception_ptr currentException = exception_;
-
-	if (waitingNumber_ == 0)
+	if (deadline == Deadline::max())
 	{
-		exception_ = nullptr;
+		cvUnload_.wait(locker, isUnloaded);
 	}
-
-	if (currentException)
+	else if (!cvUnload_.wait_until(locker, deadline, isUnloaded))
 	{
-		std::rethrow_exception(currentException);
+		waitingNumber_--;
+		return false;
 	}
+
+	releaseWaiting();
+	return true;
 }
 
-void PageSlot::waitLoad(locker_t& locker)
+bool PageSlot::waitLoad(locker_t& locker, const Deadline& deadline)
 {
 	waitingNumber_++;
 
-	cvLoad_.wait(locker, [this]()
+	auto isLoaded = [this]()
 	{
 		return !this->isLoading();
-	});
+	};
+
+	if (deadline == Deadline::max())
+	{
+		cvLoad_.wait(locker, isLoaded);
+	}
+	else if (!cvLoad_.wait_until(locker, deadline, isLoaded))
+	{
+		//The load goes on, the last waiter still gets its exception
+		waitingNumber_--;
+		return false;
+	}
 
+	releaseWaiting();
+	return true;
+}
+
+void PageSlot::releaseWaiting()
+{
 	waitingNumber_--;
 
 	std::exception_ptr currentException = exception_;
@@ -25,6 +25,8 @@ namespace cache
 		PageNumber page = INVALID_PAGE;
 		PageNumber unloadPage = INVALID_PAGE;
 		bool isDirty = false;
+		unsigned long hitCount = 0;		//hits since the page was loaded
+		bool isPrefetched = false;		//loaded ahead, the first touch is not a hit
 
 		typedef std::unique_lock<std::mutex> locker_t;
 
@@ -41,12 +43,16 @@ namespace cache
 		void waitCaptureFree(locker_t& locker);
 		void waitUnload(locker_t& locker);
 		void waitLoad(locker_t& locker);
+		bool waitUnload(locker_t& locker, const Deadline& deadline);
+		bool waitLoad(locker_t& locker, const Deadline& deadline);
 
 		void notifyUnload();
 		void notifyLoad();
 		void notifyException(std::exception_ptr exception);
 
 	private:
+		void releaseWaiting();
+
 		unsigned int capturedNumber_;
 		unsigned int waitingNumber_;
 		std::condition_variable cvUnload_;
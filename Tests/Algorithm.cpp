@@ -1,5 +1,6 @@
 #include "CacheAlgorithm.h"
 #include "AlgorithmImpl.h"
+#include "CacheException.h"
 #include "TestSet.h"
 
 #include <memory>
@@ -45,19 +46,51 @@ void TestAlgoritm()
 		throw TestException("TestAlgoritm");
 
 	alg.reset(CacheAlgorithm::create(ALG_LFU));
-	alg->setPageCount(5);
+	alg->setPageCount(3);
+	if (alg->getReplacePage() != 0)
+		throw TestException("TestAlgoritm");
+	for (PageNumber slot = 0; slot < 3; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(0, PAGE_READ);
 	alg->onPageOperation(0, PAGE_READ);
 	alg->onPageOperation(0, PAGE_WRITE);
-	sampleInfo = { 1,2,0,3,4 }; ((CacheAlgorithmQueue*)alg.get())->getPageQueue(readInfo);
-	if (readInfo != sampleInfo)
+	alg->onPageOperation(1, PAGE_READ);
+	if (alg->getReplacePage() != 2)
 		throw TestException("TestAlgoritm");
-	alg->onPageOperation(4, PAGE_RESET);
-	sampleInfo = { 4,1,2,0,3 }; ((CacheAlgorithmQueue*)alg.get())->getPageQueue(readInfo);
-	if (readInfo != sampleInfo)
+	alg->onPageOperation(2, PAGE_REPLACE, 13);
+	alg->onPageOperation(2, PAGE_READ, 13);
+	alg->onPageOperation(2, PAGE_READ, 13);
+	alg->onPageOperation(2, PAGE_READ, 13);
+	if (alg->getReplacePage() != 1)
 		throw TestException("TestAlgoritm");
-	alg->onPageOperation(3, PAGE_READ);
-	sampleInfo = { 4,1,2,0,3 }; ((CacheAlgorithmQueue*)alg.get())->getPageQueue(readInfo);
-	if (readInfo != sampleInfo)
+	alg->onPageOperation(0, PAGE_RESET);
+	if (alg->getReplacePage() != 0)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_LFU));
+	alg->setPageCount(2);	//Frequencies are aged after 20 accesses
+	alg->setParameter("decay", 0.1);
+	alg->onPageOperation(0, PAGE_REPLACE, 10);
+	alg->onPageOperation(1, PAGE_REPLACE, 11);
+	for (int i = 0; i < 15; i++)
+	{
+		alg->onPageOperation(0, PAGE_READ, 10);
+	}
+	alg->onPageOperation(1, PAGE_READ, 11);		//This access follows PAGE_REPLACE and is not counted
+	alg->onPageOperation(1, PAGE_READ, 11);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	if (alg->getReplacePage() != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_READ, 11);		//Aging: frequency of page 10 is 15 * 0.1, page 11 is 5 * 0.1
+	if (alg->getReplacePage() != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_READ, 11);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	if (alg->getReplacePage() != 0)
 		throw TestException("TestAlgoritm");
 
 	alg.reset(CacheAlgorithm::create(ALG_MRU));
@@ -87,6 +120,60 @@ void TestAlgoritm()
 	if (page != 0)
 		throw TestException("TestAlgoritm");
 
+	alg->setPageCount(1000);
+	for (PageNumber slot = 0; slot < 1000; slot++)
+	{
+		if (slot != 700)
+			alg->onPageOperation(slot, PAGE_READ);
+	}
+	page = alg->getReplacePage();		//The hand skips the fully referenced words
+	if (page != 700)
+		throw TestException("TestAlgoritm");
+	page = alg->getReplacePage();
+	if (page != 700)
+		throw TestException("TestAlgoritm");
+	page = alg->getReplacePage();		//Pages 701..999 and 0 are cleared after the wrap around
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+
+	//The bitmap must give the same victims as a plain scan of the reference bits
+	{
+		std::vector<bool> bits(300, false);
+		size_t hand = 0;
+		unsigned int seed = 1;
+		alg->setPageCount(bits.size());
+		for (int i = 0; i < 10000; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			if ((seed >> 16) % 4 != 0)
+			{
+				//Runs of referenced pages fill whole words
+				PageNumber first = (seed >> 8) % bits.size();
+				PageNumber last = std::min<PageNumber>(bits.size(), first + (seed >> 4) % 200);
+				for (PageNumber slot = first; slot < last; slot++)
+				{
+					bits[slot] = true;
+					alg->onPageOperation(slot, PAGE_READ);
+				}
+				continue;
+			}
+
+			size_t saved = hand;
+			hand = (hand + 1) % bits.size();
+			if (bits[saved])
+			{
+				while (hand != saved && bits[hand])
+				{
+					bits[hand] = false;
+					hand = (hand + 1) % bits.size();
+				}
+				saved = hand;
+			}
+			if (alg->getReplacePage() != saved)
+				throw TestException("TestAlgoritm");
+		}
+	}
+
 	alg.reset(CacheAlgorithm::create(ALG_NRU));
 	alg->setPageCount(4);
 	((caNRU*)alg.get())->setTimerInterval(60000);
@@ -108,6 +195,106 @@ void TestAlgoritm()
 	page = alg->getReplacePage();
 	if (page != 1)
 		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_READ);		//Referenced in the new epoch
+	page = alg->getReplacePage();
+	if (page != 3)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(3, PAGE_WRITE);
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+	alg->setParameter("timeout", 1000);
+	if (alg->getParameter("timeout") != 1000)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_CLOCK_PRO));
+	alg->setPageCount(3);
+	for (PageNumber slot = 0; slot < 3; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_READ, 11);
+	alg->onPageOperation(0, PAGE_REPLACE, 13);	//Page 10 stays on the clock as a test page
+	alg->onPageOperation(0, PAGE_READ, 13);
+	page = alg->getReplacePage();				//Page 11 becomes hot
+	if (page != 2)
+		throw TestException("TestAlgoritm");
+	if (alg->getParameter("cold") != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(2, PAGE_REPLACE, 10);	//Page 10 is reused during its test period
+	alg->onPageOperation(2, PAGE_READ, 10);
+	if (alg->getParameter("cold") != 2)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_SIEVE));
+	alg->setPageCount(3);
+	for (PageNumber slot = 0; slot < 3; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(0, PAGE_READ, 10);
+	page = alg->getReplacePage();				//The hand skips visited page 10
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_REPLACE, 13);
+	alg->onPageOperation(1, PAGE_READ, 13);
+	page = alg->getReplacePage();
+	if (page != 2)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_S3FIFO));
+	alg->setPageCount(10);		//Small queue of 1 page
+	for (PageNumber slot = 0; slot < 10; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(0, PAGE_READ, 10);
+	page = alg->getReplacePage();				//Page 10 is moved to the main queue
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_REPLACE, 20);	//Page 11 goes to the ghost queue
+	alg->onPageOperation(1, PAGE_READ, 20);
+	page = alg->getReplacePage();
+	if (page != 2)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(2, PAGE_REPLACE, 11);	//Page 11 is found in the ghost queue and goes to the main queue
+	alg->onPageOperation(2, PAGE_READ, 11);
+	page = alg->getReplacePage();
+	if (page != 3)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_GREEDY_DUAL));
+	alg->setPageCount(2);
+	alg->onPageOperation(0, PAGE_REPLACE, 10);
+	alg->onPageCost(0, 100);
+	alg->onPageOperation(0, PAGE_READ, 10);
+	alg->onPageOperation(1, PAGE_REPLACE, 11);
+	alg->onPageCost(1, 1);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	for (PageNumber storagePage = 12; storagePage < 60; storagePage++)
+	{
+		page = alg->getReplacePage();			//The cheap page is evicted until the inflation reaches the cost of page 10
+		if (page != 1)
+			throw TestException("TestAlgoritm");
+		alg->onPageOperation(1, PAGE_REPLACE, storagePage);
+		alg->onPageCost(1, 1);
+		alg->onPageOperation(1, PAGE_READ, storagePage);
+	}
+	alg->onPageOperation(0, PAGE_READ, 10);		//A hit restores the priority of page 10
+	PageNumber storagePage = 60;
+	while (alg->getReplacePage() == 1 && storagePage < 1000)
+	{
+		alg->onPageOperation(1, PAGE_REPLACE, storagePage++);
+		alg->onPageCost(1, 1);
+	}
+	if (storagePage < 150 || storagePage >= 1000)
+		throw TestException("TestAlgoritm");
 
 	alg.reset(CacheAlgorithm::create(ALG_RANDOM));
 	alg->setPageCount(5);
@@ -115,5 +302,273 @@ void TestAlgoritm()
 	page = alg->getReplacePage();
 	page = alg->getReplacePage();
 
+	alg.reset(CacheAlgorithm::create(ALG_ARC));
+	alg->setPageCount(2);
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(0, PAGE_REPLACE, 10);
+	alg->onPageOperation(0, PAGE_READ, 10);
+	page = alg->getReplacePage();
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_REPLACE, 11);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	alg->onPageOperation(0, PAGE_READ, 10);		//Page 10 goes to T2
+	page = alg->getReplacePage();
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_REPLACE, 12);	//Page 11 goes to B1
+	alg->onPageOperation(1, PAGE_READ, 12);
+	if (alg->getParameter("p") != 0)
+		throw TestException("TestAlgoritm");
+	page = alg->getReplacePage();
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_REPLACE, 11);	//Ghost hit in B1
+	alg->onPageOperation(1, PAGE_READ, 11);
+	if (alg->getParameter("p") != 1)
+		throw TestException("TestAlgoritm");
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(0, PAGE_RESET);
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_2Q));
+	alg->setPageCount(4);
+	for (PageNumber slot = 0; slot < 4; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(0, PAGE_REPLACE, 14);	//Page 10 goes to A1out
+	alg->onPageOperation(0, PAGE_READ, 14);
+	page = alg->getReplacePage();
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_REPLACE, 10);	//Page 10 is found in A1out and goes to Am
+	alg->onPageOperation(1, PAGE_READ, 10);
+	alg->onPageOperation(1, PAGE_READ, 10);
+	page = alg->getReplacePage();
+	if (page != 2)
+		throw TestException("TestAlgoritm");
+	alg->setParameter("kin", 0.9);
+	page = alg->getReplacePage();
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	if (alg->getParameter("kout") != 0.5)
+		throw TestException("TestAlgoritm");
+	try
+	{
+		alg->setParameter("kin", 1.5);
+		throw TestException("TestAlgoritm");
+	}
+	catch (const cache_exception&)
+	{
+	}
+
+	alg.reset(CacheAlgorithm::create(ALG_LIRS));
+	alg->setPageCount(3);
+	alg->setParameter("hir", 0.34);		//2 LIR pages and 1 HIR page
+	for (PageNumber slot = 0; slot < 3; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	page = alg->getReplacePage();
+	if (page != 2)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(2, PAGE_REPLACE, 13);	//Page 12 stays in the stack as non-resident
+	alg->onPageOperation(2, PAGE_READ, 13);
+	page = alg->getReplacePage();
+	if (page != 2)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(2, PAGE_REPLACE, 12);	//Page 12 becomes LIR, page 10 becomes HIR
+	alg->onPageOperation(2, PAGE_READ, 12);
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_TINYLFU));
+	alg->setPageCount(4);	//Window of 1 page
+	for (PageNumber slot = 0; slot < 4; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(1, PAGE_READ, 11);		//Page 11 goes to the protected segment
+	alg->onPageOperation(1, PAGE_READ, 11);
+	page = alg->getReplacePage();
+	if (page != 3)		//The window candidate is not more frequent than the probation victim
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(3, PAGE_READ, 13);
+	alg->onPageOperation(3, PAGE_READ, 13);
+	page = alg->getReplacePage();
+	if (page != 0)		//The window candidate is admitted, the probation victim is evicted
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(0, PAGE_REPLACE, 14);
+	alg->onPageOperation(0, PAGE_READ, 14);
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_LRU_K));
+	alg->setPageCount(3);
+	alg->setParameter("crp", 1);
+	for (PageNumber slot = 0; slot < 3; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(2, PAGE_READ, 12);		//Correlated with the load of page 12
+	alg->onPageOperation(1, PAGE_READ, 11);
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(0, PAGE_READ, 10);
+	page = alg->getReplacePage();
+	if (page != 2)		//Page 12 has a single uncorrelated reference
+		throw TestException("TestAlgoritm");
+
+	alg->setParameter("crp", 0);
+	alg->setPageCount(2);
+	for (PageNumber slot = 0; slot < 2; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(0, PAGE_READ, 10);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	page = alg->getReplacePage();
+	if (page != 0)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(0, PAGE_REPLACE, 12);
+	alg->onPageOperation(0, PAGE_READ, 12);
+	alg->onPageOperation(0, PAGE_REPLACE, 10);	//The history of page 10 is retained
+	alg->onPageOperation(0, PAGE_READ, 10);
+	page = alg->getReplacePage();
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+
+	try
+	{
+		alg->setParameter("k", 0);
+		throw TestException("TestAlgoritm");
+	}
+	catch (const cache_exception&)
+	{
+	}
+
+	try
+	{
+		alg->setParameter("k", 17);
+		throw TestException("TestAlgoritm");
+	}
+	catch (const cache_exception&)
+	{
+	}
+
+	alg->setPageCount(2);
+	alg->onPageOperation(1, PAGE_REPLACE, 11);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	alg->onPageOperation(0, PAGE_REPLACE, 10);
+	alg->onPageOperation(0, PAGE_READ, 10);
+	alg->onPageOperation(0, PAGE_READ, 10);
+	alg->setParameter("k", 1);					//The history of the loaded pages is kept
+	page = alg->getReplacePage();
+	if (page != 1 || alg->getParameter("k") != 1)
+		throw TestException("TestAlgoritm");
+	alg->setParameter("k", 3);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	page = alg->getReplacePage();
+	if (page != 0)		//Both pages have less than 3 references, page 10 is less recent
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_SAMPLED_LRU));
+	alg->setPageCount(4);
+	alg->setParameter("seed", 1);
+	alg->setParameter("samples", 64);		//The sample covers all slots
+	for (PageNumber slot = 0; slot < 4; slot++)
+	{
+		page = alg->getReplacePage();
+		if (page != slot)		//Free slots go first
+			throw TestException("TestAlgoritm");
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(0, PAGE_READ, 10);
+	alg->onPageOperation(1, PAGE_READ, 11);
+	alg->onPageOperation(3, PAGE_READ, 13);
+	page = alg->getReplacePage();
+	if (page != 2)
+		throw TestException("TestAlgoritm");
+	alg->onPageOperation(1, PAGE_RESET);
+	page = alg->getReplacePage();
+	if (page != 1)
+		throw TestException("TestAlgoritm");
+	if (alg->getParameter("samples") != 64)
+		throw TestException("TestAlgoritm");
+
+	try
+	{
+		alg->setParameter("samples", 0);
+		throw TestException("TestAlgoritm");
+	}
+	catch (const cache_exception&)
+	{
+	}
+
+	std::vector<PageNumber> candidates;
+	alg.reset(CacheAlgorithm::create(ALG_LRU));
+	alg->setPageCount(4);
+	alg->onPageOperation(2, PAGE_READ);
+	alg->onPageOperation(0, PAGE_READ);
+	alg->getReplaceCandidates(candidates, 3);
+	if (candidates != std::vector<PageNumber>({ 1, 3, 2 }))
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_CLOCK));
+	alg->setPageCount(4);
+	alg->onPageOperation(1, PAGE_READ);
+	alg->getReplaceCandidates(candidates, 3);		//The pages without the reference bit go first
+	if (candidates != std::vector<PageNumber>({ 0, 2, 3 }))
+		throw TestException("TestAlgoritm");
+
+	alg->getReplaceCandidates(candidates, 3);		//The hand does not move
+	if (candidates != std::vector<PageNumber>({ 0, 2, 3 }) || alg->getReplacePage() != 0)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_SIEVE));
+	alg->setPageCount(3);
+	for (PageNumber slot = 0; slot < 3; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(0, PAGE_READ, 10);
+	alg->getReplaceCandidates(candidates, 3);		//The visited page is not a candidate and keeps its bit
+	alg->getReplaceCandidates(candidates, 3);
+	if (candidates != std::vector<PageNumber>({ 1, 2 }) || alg->getReplacePage() != 1)
+		throw TestException("TestAlgoritm");
+
+	alg.reset(CacheAlgorithm::create(ALG_S3FIFO));
+	alg->setPageCount(4);
+	for (PageNumber slot = 0; slot < 4; slot++)
+	{
+		alg->onPageOperation(slot, PAGE_REPLACE, 10 + slot);
+		alg->onPageOperation(slot, PAGE_READ, 10 + slot);
+	}
+	alg->onPageOperation(2, PAGE_RESET);
+	page = alg->getReplacePage();
+	alg->getReplaceCandidates(candidates, 4);		//The free slot, then the other pages
+	if (candidates.size() != 4 || candidates[0] != page || page != 2)
+		throw TestException("TestAlgoritm");
+
 	printf("Successfull\n");
 }
\ No newline at end of file
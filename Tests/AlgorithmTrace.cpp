@@ -0,0 +1,157 @@
+#include "CacheAlgorithm.h"
+#include "TestSet.h"
+
+#include <memory>
+#include <vector>
+#include <random>
+#include <unordered_map>
+#include <cmath>
+
+using namespace cache;
+
+typedef std::vector<PageNumber> PageTrace;
+
+//Replays the trace the same way the controller does and returns the hit ratio
+static double RunTrace(ReplaceAlgoritm algoritm, PageCount pageCount, const PageTrace& trace)
+{
+	std::unique_ptr<CacheAlgorithm> alg(CacheAlgorithm::create(algoritm));
+	alg->setPageCount(pageCount);
+
+	std::unordered_map<PageNumber, SlotIndex> location;
+	std::vector<PageNumber> slotPage(pageCount, INVALID_PAGE);
+	unsigned long hitCount = 0;
+
+	for (PageNumber page : trace)
+	{
+		auto found = location.find(page);
+		if (found != location.end())
+		{
+			hitCount++;
+			alg->onPageOperation(found->second, PAGE_READ, page);
+			continue;
+		}
+
+		SlotIndex slot = alg->getReplacePage();
+		if (slotPage[slot] != INVALID_PAGE)
+		{
+			location.erase(slotPage[slot]);
+		}
+		slotPage[slot] = page;
+		location[page] = slot;
+
+		alg->onPageOperation(slot, PAGE_REPLACE, page);
+		alg->onPageOperation(slot, PAGE_READ, page);
+	}
+
+	return (double)hitCount / trace.size();
+}
+
+static void MakeLoopTrace(PageTrace& trace, PageCount loopSize, size_t length)
+{
+	trace.clear();
+	for (size_t i = 0; i < length; i++)
+	{
+		trace.push_back(i % loopSize);
+	}
+}
+
+static void MakeZipfTrace(PageTrace& trace, PageCount pageSpace, double exponent, size_t length)
+{
+	std::vector<double> weights;
+	for (PageNumber page = 0; page < pageSpace; page++)
+	{
+		weights.push_back(1.0 / std::pow(page + 1, exponent));
+	}
+
+	std::mt19937 generator(12345);
+	std::discrete_distribution<PageNumber> distribution(weights.begin(), weights.end());
+
+	trace.clear();
+	for (size_t i = 0; i < length; i++)
+	{
+		trace.push_back(distribution(generator));
+	}
+}
+
+void TestAlgoritmTrace()
+{
+	printf("TestAlgoritmTrace\n");
+
+	const PageCount pageCount = 100;
+
+	struct
+	{
+		ReplaceAlgoritm algoritm;
+		const char* name;
+		double loopRatio;
+		double zipfRatio;
+	} results[] =
+	{
+		{ ALG_LRU, "LRU", 0, 0 },
+		{ ALG_CLOCK, "CLOCK", 0, 0 },
+		{ ALG_LIRS, "LIRS", 0, 0 },
+		{ ALG_TINYLFU, "TinyLFU", 0, 0 },
+		{ ALG_LFU, "LFU", 0, 0 },
+		{ ALG_CLOCK_PRO, "CLOCK-Pro", 0, 0 },
+		{ ALG_SIEVE, "SIEVE", 0, 0 },
+		{ ALG_S3FIFO, "S3-FIFO", 0, 0 },
+		{ ALG_LRU_K, "LRU-2", 0, 0 },
+		{ ALG_SAMPLED_LRU, "SampledLRU", 0, 0 },
+	};
+
+	PageTrace loopTrace;
+	PageTrace zipfTrace;
+	MakeLoopTrace(loopTrace, pageCount + pageCount / 10, 100000);
+	MakeZipfTrace(zipfTrace, pageCount * 10, 0.9, 100000);
+
+	for (auto& result : results)
+	{
+		result.loopRatio = RunTrace(result.algoritm, pageCount, loopTrace);
+		result.zipfRatio = RunTrace(result.algoritm, pageCount, zipfTrace);
+		printf("%-10s loop=%.3f zipf=%.3f\n", result.name, result.loopRatio, result.zipfRatio);
+	}
+
+	const auto& lru = results[0];
+	const auto& clock = results[1];
+	const auto& lirs = results[2];
+
+	//A loop slightly larger than the cache is the worst case for LRU and CLOCK
+	if (lirs.loopRatio < 0.5 || lirs.loopRatio <= lru.loopRatio || lirs.loopRatio <= clock.loopRatio)
+		throw TestException("TestAlgoritmTrace");
+
+	if (lirs.zipfRatio < lru.zipfRatio * 0.95)
+		throw TestException("TestAlgoritmTrace");
+
+	//Frequency based admission must win on a skewed workload
+	const auto& tinyLfu = results[3];
+	if (tinyLfu.zipfRatio <= lru.zipfRatio || tinyLfu.loopRatio <= lru.loopRatio)
+		throw TestException("TestAlgoritmTrace");
+
+	//Lazy promotion must not lose to LRU on a skewed workload
+	const auto& sieve = results[6];
+	const auto& s3fifo = results[7];
+	if (sieve.zipfRatio < lru.zipfRatio || s3fifo.zipfRatio < lru.zipfRatio)
+		throw TestException("TestAlgoritmTrace");
+
+	//The frequency keeps the popular pages on a skewed workload
+	const auto& lfu = results[4];
+	if (lfu.zipfRatio <= lru.zipfRatio)
+		throw TestException("TestAlgoritmTrace");
+
+	//The test period of the cold pages protects a loop as LIRS does
+	const auto& clockPro = results[5];
+	if (clockPro.loopRatio < 0.5 || clockPro.loopRatio <= clock.loopRatio || clockPro.zipfRatio <= clock.zipfRatio)
+		throw TestException("TestAlgoritmTrace");
+
+	//The second to last reference filters out the pages seen once
+	const auto& lruK = results[8];
+	if (lruK.zipfRatio <= lru.zipfRatio)
+		throw TestException("TestAlgoritmTrace");
+
+	//A small random sample must be close to the exact LRU
+	const auto& sampledLru = results[9];
+	if (sampledLru.zipfRatio < lru.zipfRatio * 0.95)
+		throw TestException("TestAlgoritmTrace");
+
+	printf("Successfull\n");
+}
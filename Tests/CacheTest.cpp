@@ -8,9 +8,23 @@ int main()
 	{
 		TestWhiteBox();
 		TestAlgoritm();
+		TestAlgoritmTrace();
 		TestRW();
 		TestWhiteboxException();
+		TestWhiteBoxCost();
+		TestWhiteBoxReclaim();
+		TestWhiteBoxReadAround();
+		TestWhiteBoxBypass();
 		TestWhiteBoxMT();
+		TestWhiteBoxPreCleanerMT();
+		TestWhiteBoxCleanFirstMT();
+		TestWhiteBoxStagingMT();
+		TestWhiteBoxDeadlineMT();
+		TestWhiteBoxHedgedReadMT();
+		TestWhiteBoxIoLimitMT();
+		TestWhiteBoxSchedulerMT();
+		TestWhiteBoxLoadThreadsMT();
+		TestWhiteBoxVectorIoMT();
 		TestWhiteBoxExceptionMT();
 		TestReadWriteMT();
 	}
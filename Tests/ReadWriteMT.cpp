@@ -4,9 +4,9 @@
 
 using namespace cache;
 
-void ReadWriteMT(const RandomSetup& setup)
+CacheStatistic ReadWriteMT(const RandomSetup& setup)
 {
-	printf("TestReadWriteMT: pCount=%u pSize=%u space=%u read=%u write=%u op=%u addr=%s ex=%u\n", setup.pageCount, setup.pageSize, setup.spaceSize, setup.countRead, setup.countWrite, setup.operationCount,  setup.fixedAddress ? "fix" : "rand", setup.intervalException);
+	printf("TestReadWriteMT: pCount=%u pSize=%u space=%u read=%u write=%u op=%u addr=%s ex=%u alg=%u\n", setup.pageCount, setup.pageSize, setup.spaceSize, setup.countRead, setup.countWrite, setup.operationCount,  setup.fixedAddress ? "fix" : "rand", setup.intervalException, setup.algoritm);
 
 	TestControllerMT cache;
 	
@@ -40,6 +40,8 @@ void ReadWriteMT(const RandomSetup& setup)
 	}
 
 	printf("Successfull\n");
+
+	return cache.getStatistic();
 }
 
 void TestRW_1_1_Fixed()
@@ -170,6 +172,32 @@ void TestRW_3_3_Random_huge()
 	ReadWriteMT(setup);
 }
 
+void TestRW_3_3_Random_algorithms()
+{
+	RandomSetup setup;
+
+	setup.countRead = 3; setup.countWrite = 3;
+	setup.fixedAddress = false;
+	setup.randomSeed = true;
+	setup.pageCount = 20;
+	setup.pageSize = 5;
+	setup.spaceSize = 1000;
+	setup.operationCount = 1000;
+	setup.intervalFlush = 100;
+	setup.intervalException = 0;
+
+	for (int algoritm = ALG_LRU; algoritm <= ALG_SAMPLED_LRU; algoritm++)
+	{
+		setup.algoritm = (ReplaceAlgoritm)algoritm;
+
+		//Not more slots are busy than threads run, so a busy victim never ends in the direct I/O
+		if (ReadWriteMT(setup).directCount != 0)
+		{
+			throw TestException("TestRW_3_3_Random_algorithms");
+		}
+	}
+}
+
 void TestReadWriteMT()
 {
 	TestRW_1_1_Fixed();
@@ -177,5 +205,6 @@ void TestReadWriteMT()
 	TestRW_3_3_Random_small();
 	TestRW_3_3_Random_small_exception();
 	TestRW_3_3_Random_big();
+	TestRW_3_3_Random_algorithms();
 	TestRW_3_3_Random_huge();
 }
\ No newline at end of file
@@ -20,6 +20,7 @@ void TestControllerMT::run(const RandomSetup& setup)
 	}
 
 	setupPages(setup.pageCount, setup.pageSize);
+	setReplaceAlgoritm(setup.algoritm);
 
 	spaceSize_ = setup.spaceSize;
 	operationCount_ = setup.operationCount;
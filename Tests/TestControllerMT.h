@@ -20,6 +20,7 @@ namespace cache
 		unsigned int intervalException = 0;
 		PageCount pageCount = 0;
 		PageSize  pageSize = 0;
+		ReplaceAlgoritm algoritm = ALG_LRU;
 		bool fixedAddress = false;
 		bool randomSeed = true;
 		bool bLog = false;
@@ -29,6 +30,7 @@ namespace cache
 	class TestControllerMT : public PageCacheController
 	{
 	public:
+		~TestControllerMT() { shutdown(); }
 		void run(const RandomSetup& setup);
 		bool isError();
 		bool isFinished();
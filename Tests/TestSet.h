@@ -15,7 +15,21 @@ private:
 void TestWhiteBox();
 void TestRW();
 void TestWhiteboxException();
+void TestWhiteBoxCost();
+void TestWhiteBoxReclaim();
+void TestWhiteBoxReadAround();
+void TestWhiteBoxBypass();
 void TestWhiteBoxMT();
+void TestWhiteBoxPreCleanerMT();
+void TestWhiteBoxCleanFirstMT();
+void TestWhiteBoxStagingMT();
+void TestWhiteBoxDeadlineMT();
+void TestWhiteBoxHedgedReadMT();
+void TestWhiteBoxIoLimitMT();
+void TestWhiteBoxSchedulerMT();
+void TestWhiteBoxLoadThreadsMT();
+void TestWhiteBoxVectorIoMT();
 void TestWhiteBoxExceptionMT();
 void TestReadWriteMT();
 void TestAlgoritm();
+void TestAlgoritmTrace();
@@ -295,4 +295,253 @@ void TestWhiteboxException()
 		throw TestException("TestWhiteboxException");
 
 	printf("Successfull\n");
-}
\ No newline at end of file
+}
+
+void TestWhiteBoxCost()
+{
+	printf("TestWhiteBoxCost\n");
+
+	TestCacheWhiteBox cache;
+
+	const PageCount pageCount = 2;
+	const PageSize pageSize = 20;
+
+	char buffer[pageSize];
+
+	std::vector<std::pair<unsigned long, unsigned long>> readInfo;
+
+	cache.setupPages(pageCount, pageSize);
+	cache.setReplaceAlgoritm(ALG_GREEDY_DUAL);
+	cache.setCostHint(0, pageSize, 1000);			//Page 0 is expensive to reload
+	cache.setCostHint(pageSize, 100 * pageSize, 1);
+
+	bool isOverlapRejected = false;
+	try
+	{
+		cache.setCostHint(10 * pageSize, pageSize, 1000);	//Nested ranges are not supported
+	}
+	catch (const std::exception&)
+	{
+		isOverlapRejected = true;
+	}
+
+	if (!isOverlapRejected)
+		throw TestException("TestWhiteBoxCost");
+
+	cache.read(0, pageSize, buffer);				//Descriptor 0
+	for (DataAddress page = 1; page <= 10; page++)
+	{
+		cache.read(page * pageSize, pageSize, buffer);	//Descriptor 1
+	}
+
+	if (cache.countRead != 11)
+		throw TestException("TestWhiteBoxCost");
+
+	cache.getDebugInfo(readInfo, DBINFO_DESCRIPTOR_PAGE);
+	if (readInfo[0].second != 0 || readInfo[1].second != 10)
+		throw TestException("TestWhiteBoxCost");
+
+	//Without hints, the cost is the measured time of the page loading
+	cache.clearCostHints();
+	cache.read(11 * pageSize, pageSize, buffer);
+	cache.getDebugInfo(readInfo, DBINFO_DESCRIPTOR_PAGE);
+	if (readInfo[0].second != 0 || readInfo[1].second != 11)
+		throw TestException("TestWhiteBoxCost");
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxReclaim()
+{
+	printf("TestWhiteBoxReclaim\n");
+
+	TestCacheWhiteBox cache;
+
+	const PageCount pageCount = 4;
+	const PageSize pageSize = 20;
+
+	char buffer[pageSize];
+	unsigned long countReclaim = 0;
+
+	std::vector<std::pair<unsigned long, unsigned long>> readInfo;
+	std::vector<std::pair<unsigned long, unsigned long>> sampleInfo;
+
+	cache.setupPages(pageCount, pageSize);
+	cache.setReclaimBatch(2);
+	cache.setDebugTracePoint([&countReclaim](DebugTracePoint tracePoint)
+	{
+		if (tracePoint == TRACE_RECLAIM)
+			countReclaim++;
+	});
+
+	for (DataAddress page = 0; page < pageCount; page++)
+	{
+		cache.read(page * pageSize, pageSize, buffer);
+	}
+	cache.write(1 * pageSize, 10, buffer);		//Page 1 is dirty
+
+	if (countReclaim != 0)
+		throw TestException("TestWhiteBoxReclaim");
+
+	cache.read(4 * pageSize, pageSize, buffer);	//Pages 0 and 2 are reclaimed
+	cache.read(5 * pageSize, pageSize, buffer);	//The free slot is taken without the algorithm
+	if (countReclaim != 1)
+		throw TestException("TestWhiteBoxReclaim");
+
+	cache.read(2 * pageSize, pageSize, buffer);	//Page 3 is reclaimed, dirty page 1 is skipped
+	if (countReclaim != 2 || cache.countRead != 7 || cache.countWrite != 0)
+		throw TestException("TestWhiteBoxReclaim");
+
+	sampleInfo.push_back({ 0, 4 });
+	sampleInfo.push_back({ 1, 1 });
+	sampleInfo.push_back({ 2, 5 });
+	sampleInfo.push_back({ 3, 2 });
+	cache.getDebugInfo(readInfo, DBINFO_DESCRIPTOR_PAGE);
+	if (sampleInfo != readInfo)
+		throw TestException("TestWhiteBoxReclaim");
+
+	if (cache.getSettings().reclaimBatch != 2)
+		throw TestException("TestWhiteBoxReclaim");
+
+	//The reclaimed pages are evictions: ARC keeps them in its ghost list
+	TestCacheWhiteBox arcCache;
+
+	arcCache.setupPages(pageCount, pageSize);
+	arcCache.setReplaceAlgoritm(ALG_ARC);
+	arcCache.setReclaimBatch(2);
+
+	for (DataAddress page = 0; page < pageCount; page++)
+	{
+		arcCache.read(page * pageSize, pageSize, buffer);
+	}
+	arcCache.read(4 * pageSize, pageSize, buffer);	//Pages 0 and 1 are reclaimed to B1, page 4 trims page 0 from it
+	if (arcCache.getAlgoritmParameter("p") != 0)
+		throw TestException("TestWhiteBoxReclaim");
+
+	arcCache.read(1 * pageSize, pageSize, buffer);	//The ghost hit in B1 grows the T1 target
+	if (arcCache.getAlgoritmParameter("p") != 1 || arcCache.countRead != 6)
+		throw TestException("TestWhiteBoxReclaim");
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxReadAround()
+{
+	printf("TestWhiteBoxReadAround\n");
+
+	TestCacheWhiteBox cache;
+
+	const PageCount pageCount = 4;
+	const PageSize pageSize = 20;
+
+	char buffer[5 * pageSize];
+
+	std::vector<std::pair<unsigned long, unsigned long>> readInfo;
+	std::vector<std::pair<unsigned long, unsigned long>> sampleInfo;
+
+	cache.setupPages(pageCount, pageSize);
+	cache.read(0, pageSize, buffer);
+	cache.write(1 * pageSize, 10, buffer);		//Page 1 is dirty
+	cache.reset();
+	cache.resetStatistic();
+
+	//Pages 0 and 1 are taken from the cache, pages 2-4 are read by one call
+	cache.read(0, 5 * pageSize, buffer, READ_AROUND);
+	if (cache.countRead != 1 || cache.lastAddressRead != 2 * pageSize || cache.lastSizeRead != 3 * pageSize)
+		throw TestException("TestWhiteBoxReadAround");
+
+	if (cache.getStatistic().hitCount != 2 || cache.getStatistic().missCount != 3)
+		throw TestException("TestWhiteBoxReadAround");
+
+	sampleInfo.push_back({ 0, 0 });
+	sampleInfo.push_back({ 1, 1 });
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	if (sampleInfo != readInfo)
+		throw TestException("TestWhiteBoxReadAround");
+
+	//The global policy is overridden by the call
+	cache.setReadMissPolicy(READ_AROUND);
+	cache.read(3 * pageSize, pageSize, buffer);
+	cache.read(4 * pageSize, pageSize, buffer, READ_ALLOCATE);
+	if (cache.countRead != 3 || cache.getSettings().readMissPolicy != READ_AROUND)
+		throw TestException("TestWhiteBoxReadAround");
+
+	sampleInfo.push_back({ 4, 2 });
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	if (sampleInfo != readInfo || cache.countWrite != 0)
+		throw TestException("TestWhiteBoxReadAround");
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxBypass()
+{
+	printf("TestWhiteBoxBypass\n");
+
+	TestCacheWhiteBox cache;
+
+	const PageCount pageCount = 4;
+	const PageSize pageSize = 20;
+
+	char buffer[4 * pageSize];
+
+	std::vector<std::pair<unsigned long, unsigned long>> readInfo;
+	std::vector<std::pair<unsigned long, unsigned long>> sampleInfo;
+
+	cache.setupPages(pageCount, pageSize);
+
+	//The large requests go around the cache
+	cache.setBypass(3 * pageSize, 0);
+	cache.read(0, 3 * pageSize, buffer);
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	if (cache.countRead != 1 || cache.lastSizeRead != 3 * pageSize || readInfo.size() != 0)
+		throw TestException("TestWhiteBoxBypass");
+
+	cache.read(0, 2 * pageSize, buffer);
+	cache.write(0, 4 * pageSize, buffer);		//Pages 0 and 1 are written to the cache, pages 2 and 3 by one call
+	if (cache.countRead != 3 || cache.countWrite != 1 || cache.lastAddressWrite != 2 * pageSize || cache.lastSizeWrite != 2 * pageSize)
+		throw TestException("TestWhiteBoxBypass");
+
+	CacheStatistic statistic = cache.getStatistic();
+	if (statistic.bypassCount != 2 || statistic.bypassBytes != 5 * pageSize)
+		throw TestException("TestWhiteBoxBypass");
+
+	//The streams go around the cache when the evicted pages have no hits
+	cache.setBypass(0, 0.5);
+	cache.resetStatistic();
+
+	for (DataAddress page = 10; page < 90; page += 2)
+	{
+		cache.read(page * pageSize, 2 * pageSize, buffer);
+	}
+
+	//The first request fills the cache, then 64 evictions are needed, the last 7 requests are not cached
+	statistic = cache.getStatistic();
+	if (statistic.bypassCount != 7 || statistic.bypassBytes != 7 * 2 * pageSize)
+		throw TestException("TestWhiteBoxBypass");
+
+	sampleInfo.push_back({ 72, 0 });
+	sampleInfo.push_back({ 73, 1 });
+	sampleInfo.push_back({ 74, 2 });
+	sampleInfo.push_back({ 75, 3 });
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	if (sampleInfo != readInfo)
+		throw TestException("TestWhiteBoxBypass");
+
+	//A point read is cached
+	cache.read(0, 10, buffer);
+	if (cache.getStatistic().bypassCount != 7 || cache.getSettings().bypassZeroHitRatio != 0.5)
+		throw TestException("TestWhiteBoxBypass");
+
+	//A large request that does not continue a stream is cached, the next one continues its stream
+	cache.read(200 * pageSize, 2 * pageSize, buffer);
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	if (cache.getStatistic().bypassCount != 7 || readInfo.size() != 4 || readInfo[2].first != 200 || readInfo[3].first != 201)
+		throw TestException("TestWhiteBoxBypass");
+
+	cache.read(202 * pageSize, 2 * pageSize, buffer);
+	if (cache.getStatistic().bypassCount != 8)
+		throw TestException("TestWhiteBoxBypass");
+
+	printf("Successfull\n");
+}
@@ -1,4 +1,5 @@
 #include "../Source/PageCacheController.h"
+#include "../Source/IoLimiter.h"
 #include "TestSet.h"
 #include "TestHelper.h"
 
@@ -12,6 +13,12 @@ class TestCacheMTWhiteBox : public PageCacheController
 public:
 	
 
+	~TestCacheMTWhiteBox()
+	{
+		//The background threads call the storage methods of this class
+		shutdown();
+	}
+
 	TestCacheMTWhiteBox()
 	{
 		reset();
@@ -40,7 +47,8 @@ public:
 	{
 		lastAddressRead = 0; lastAddressWrite = 0;
 		lastSizeRead = 0; lastSizeWrite = 0;
-		countWrite = 0; countRead = 0;
+		countWrite = 0; countRead = 0; countHedgedRead = 0;
+		countWriteV = 0; countReadV = 0; lastRangesWrite = 0; lastRangesRead = 0;
 		holdRead_ = false;  holdWrite_ = false;
 		holdReadStart_ = false; holdWriteStart_ = false;
 		outHoldRead_ = false; outHoldWrite_ = false;
@@ -67,6 +75,11 @@ public:
 		
 	std::atomic_uint  countWrite;
 	std::atomic_uint  countRead;
+	std::atomic_uint  countHedgedRead;
+	std::atomic_uint  countWriteV;
+	std::atomic_uint  countReadV;
+	std::atomic<size_t> lastRangesWrite;
+	std::atomic<size_t> lastRangesRead;
 	std::atomic<DataAddress> lastAddressRead;
 	std::atomic<DataAddress> lastAddressWrite;
 	std::atomic<DataSize> lastSizeRead;
@@ -109,6 +122,26 @@ private:
 		}
 	}
 
+	void readStorageHedged(DataAddress address, DataSize size, void* dataBuffer, void* metaData) override
+	{
+		countHedgedRead++;
+		::memset(dataBuffer, 'h', size);
+	}
+
+	void readStorageV(const std::vector<StorageRange>& ranges, void* metaData) override
+	{
+		lastRangesRead = ranges.size();
+		countReadV++;
+		PageCacheController::readStorageV(ranges, metaData);
+	}
+
+	void writeStorageV(const std::vector<StorageRange>& ranges, void* metaData) override
+	{
+		lastRangesWrite = ranges.size();
+		countWriteV++;
+		PageCacheController::writeStorageV(ranges, metaData);
+	}
+
 	void writeStorage(DataAddress address, DataSize size, const void* dataBuffer, void* metaData) override
 	{
 		lastAddressWrite = address; lastSizeWrite = size;
@@ -142,6 +175,18 @@ void Verify(const char* testName, TestCacheMTWhiteBox& cache, bool condition)
 	}
 }
 
+void ReadCache(TestCacheMTWhiteBox& cache, DataAddress address, DataSize size)
+{
+	std::unique_ptr<char[]> buffer(new char[size]);
+	cache.read(address, size, buffer.get());
+}
+
+void WriteCache(TestCacheMTWhiteBox& cache, DataAddress address, DataSize size)
+{
+	std::unique_ptr<char[]> buffer(new char[size]);
+	cache.write(address, size, buffer.get());
+}
+
 void TestWhiteBoxMT()
 {
 	const char* testName = "TestWhiteBoxMT";
@@ -156,12 +201,12 @@ void TestWhiteBoxMT()
 
 	auto write = [&cache](DataAddress address, DataSize size) 
 	{
-		std::unique_ptr<char> buffer(new char[size]);
+		std::unique_ptr<char[]> buffer(new char[size]);
 		cache.write(address, size, buffer.get());
 	};
 	auto read = [&cache](DataAddress address, DataSize size) 
 	{
-		std::unique_ptr<char> buffer(new char[size]);
+		std::unique_ptr<char[]> buffer(new char[size]);
 		cache.read(address, size, buffer.get());
 	};
 
@@ -248,6 +293,638 @@ void TestWhiteBoxMT()
 	descriptors.push_back({ STATE_READY,  3, INVALID_PAGE, 0, 1 });
 	Verify(testName, cache, CheckDescriptor(descriptors, cache, CHECK_ALL));
 
+	//The victim is loading: the next candidate is replaced instead of the direct reading
+	cache.setupPages(2, 10);
+	cache.setReplaceAlgoritm(ALG_MRU);
+	read(0, 10);
+	read(10, 10);	//MRU: page 1 replaces page 0, slot 1 stays free
+	cache.resetStatistic();
+	unsigned int countRead = cache.countRead;
+	cache.setHoldRead(true);
+	auto f5 = std::async(std::launch::async, read, 20, 5); //page 2 replaces page 1
+	cache.waitHoldRead();
+	auto f6 = std::async(std::launch::async, read, 30, 5); //page 3 goes to the free slot
+	while (cache.countRead < countRead + 2)
+	{
+		std::this_thread::yield();
+	}
+
+	descriptors.clear();
+	descriptors.push_back({ STATE_LOAD,  2, INVALID_PAGE, 0, 0 });
+	descriptors.push_back({ STATE_LOAD,  3, INVALID_PAGE, 0, 0 });
+	Verify(testName, cache, CheckDescriptor(descriptors, cache, CHEK_STATE | CHECK_PAGE));
+
+	cache.setHoldRead(false);
+	f5.wait(); f6.wait();
+	Verify(testName, cache, cache.getStatistic().directCount == 0);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxPreCleanerMT()
+{
+	const char* testName = "TestWhiteBoxPreCleanerMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	std::vector<std::pair<unsigned long, unsigned long>> readInfo;
+	std::vector<std::pair<unsigned long, unsigned long>> sampleInfo;
+
+	auto waitCountWrite = [&cache](unsigned int count)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (cache.countWrite < count && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::yield();
+		}
+		return cache.countWrite == count;
+	};
+
+	char buffer[10];
+
+	cache.setupPages(4, 10);
+	for (DataAddress page = 0; page < 4; page++)
+	{
+		cache.write(page * 10, 10, buffer);	//All pages are dirty
+	}
+	cache.reset();
+
+	cache.setFreePool(2, 2);		//Pages 0 and 1 are written and released in the background
+	Verify(testName, cache, waitCountWrite(2));
+
+	sampleInfo.push_back({ 2, 2 });
+	sampleInfo.push_back({ 3, 3 });
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	Verify(testName, cache, sampleInfo == readInfo);
+
+	cache.read(40, 10, buffer);		//The free slot is taken, page 2 is released in the background
+	Verify(testName, cache, cache.countRead == 1 && cache.lastAddressRead == 40);
+	Verify(testName, cache, waitCountWrite(3) && cache.lastAddressWrite == 20);
+	Verify(testName, cache, cache.getStatistic().writebackCount == 0);
+
+	cache.read(0, 10, buffer);		//The page written by the pre-cleaner is read again
+	Verify(testName, cache, cache.countRead == 2 && cache.lastAddressRead == 0);
+
+	auto waitPageCount = [&cache](size_t count)
+	{
+		std::vector<std::pair<unsigned long, unsigned long>> info;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		do
+		{
+			std::this_thread::yield();
+			cache.getDebugInfo(info, DBINFO_LOCATION_TABLE);
+		} while (info.size() != count && std::chrono::steady_clock::now() < deadline);
+		return info.size() == count;
+	};
+
+	//The pre-cleaner is stopped while the slot table is rebuilt, then it keeps the pool again
+	cache.setupPages(4, 10);
+	for (DataAddress page = 0; page < 4; page++)
+	{
+		cache.read(page * 10, 10, buffer);
+	}
+	Verify(testName, cache, waitPageCount(2));
+
+	cache.clear();
+	cache.read(0, 10, buffer);
+	Verify(testName, cache, waitPageCount(1));
+
+	//The algorithm is replaced while the pre-cleaner and a reader use it
+	std::atomic<bool> isRun(true);
+	auto reader = std::async(std::launch::async, [&cache, &isRun]()
+	{
+		char data[10];
+		for (DataAddress page = 0; isRun; page = (page + 1) % 16)
+		{
+			cache.read(page * 10, 10, data);
+		}
+	});
+	for (int algoritm = ALG_LRU; algoritm <= ALG_SAMPLED_LRU; algoritm++)
+	{
+		cache.setReplaceAlgoritm(static_cast<ReplaceAlgoritm>(algoritm));
+	}
+	cache.setReplaceAlgoritm(ALG_LRU_K);
+	cache.setAlgoritmParameter("k", 3);
+	isRun = false;
+	reader.get();
+	cache.setReplaceAlgoritm(ALG_LRU);
+
+	cache.setFreePool(0, 0);
+	Verify(testName, cache, cache.getSettings().freePoolLowWater == 0);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxCleanFirstMT()
+{
+	const char* testName = "TestWhiteBoxCleanFirstMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	std::vector<std::pair<unsigned long, unsigned long>> readInfo;
+	std::vector<std::pair<unsigned long, unsigned long>> sampleInfo;
+
+	auto waitCountWrite = [&cache](unsigned int count)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (cache.countWrite < count && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::yield();
+		}
+		return cache.countWrite == count;
+	};
+
+	char buffer[10];
+
+	cache.setupPages(3, 10);
+	cache.write(0, 10, buffer);		//Descriptor 0 is dirty
+	cache.read(10, 10, buffer);
+	cache.read(20, 10, buffer);
+
+	cache.setCleanFirst(3, 2);
+	cache.read(30, 10, buffer);		//Clean page 1 is replaced instead of dirty page 0, the pre-cleaner writes page 0
+	Verify(testName, cache, waitCountWrite(1) && cache.lastAddressWrite == 0);
+	cache.setCleanFirst(3, 2);		//The pre-cleaner is stopped after the write and started again
+
+	CacheStatistic statistic = cache.getStatistic();
+	Verify(testName, cache, statistic.writebackCount == 0 && statistic.cleanFirstSkipCount == 1);
+
+	cache.read(40, 10, buffer);		//Page 0 is clean now and is replaced without a write
+	statistic = cache.getStatistic();
+	Verify(testName, cache, cache.countWrite == 1 && statistic.writebackCount == 0 && statistic.cleanFirstSkipCount == 1);
+
+	sampleInfo.push_back({ 0, 4 });
+	sampleInfo.push_back({ 1, 3 });
+	sampleInfo.push_back({ 2, 2 });
+	cache.getDebugInfo(readInfo, DBINFO_DESCRIPTOR_PAGE);
+	Verify(testName, cache, sampleInfo == readInfo);
+
+	//Without a clean candidate the miss writes the dirty victim itself
+	for (DataAddress page = 2; page < 5; page++)
+	{
+		cache.write(page * 10, 10, buffer);
+	}
+	cache.read(50, 10, buffer);
+	statistic = cache.getStatistic();
+	Verify(testName, cache, cache.countWrite == 2 && cache.lastAddressWrite == 20 && statistic.writebackCount == 1);
+
+	cache.setCleanFirst(0, 0);
+	Verify(testName, cache, cache.getSettings().cleanFirstCount == 0);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxStagingMT()
+{
+	const char* testName = "TestWhiteBoxStagingMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	char buffer0[10] = "page 0";
+	char buffer1[10] = "page 1";
+	char readBuffer[10];
+
+	cache.setupPages(2, 10);
+	cache.setCleanBeforeLoad(true);
+	cache.write(0, 10, buffer0);
+	cache.write(10, 10, buffer1);
+	cache.setWritebackBuffers(2);
+	cache.reset();
+
+	cache.setHoldWrite(true);
+	cache.read(20, 10, readBuffer);		//Page 0 is staged, the read does not wait for the write
+	cache.waitHoldWrite();
+	Verify(testName, cache, cache.countRead == 1 && cache.countWrite == 1 && cache.lastAddressWrite == 0);
+
+	cache.read(30, 10, readBuffer);		//Page 1 is staged and waits for the writer
+	Verify(testName, cache, cache.countRead == 2 && cache.countWrite == 1);
+
+	cache.read(10, 10, readBuffer);		//Page 1 is taken back from the buffer
+	Verify(testName, cache, cache.countRead == 2 && ::memcmp(readBuffer, buffer1, 10) == 0);
+
+	cache.setHoldWrite(false);
+	cache.flush();						//Waits for page 0 and writes page 1 from the cache
+	Verify(testName, cache, cache.countWrite == 2 && cache.lastAddressWrite == 10);
+
+	CacheStatistic statistic = cache.getStatistic();
+	Verify(testName, cache, statistic.writebackCount == 0 && statistic.stagedWriteCount == 2);
+
+	//No free slot for a staged page: the staged copy reaches the storage before the direct write
+	cache.setupPages(1, 10);
+	cache.write(0, 10, buffer0);
+	cache.reset();
+	cache.resetStatistic();
+
+	cache.setHoldWrite(true);
+	cache.setHoldRead(true);
+	auto f0 = std::async(std::launch::async, ReadCache, std::ref(cache), 10, 10);		//Page 0 is staged, page 1 is loading
+	cache.waitHoldWrite();
+	cache.waitHoldRead();
+	auto f1 = std::async(std::launch::async, WriteCache, std::ref(cache), 0, 5);		//Waits for the staged write
+	cache.setHoldWrite(false);
+	f1.get();
+	Verify(testName, cache, cache.countWrite == 2 && cache.lastAddressWrite == 0 && cache.lastSizeWrite == 5);
+
+	cache.setHoldRead(false);
+	f0.get();
+	Verify(testName, cache, cache.getStatistic().directCount == 1);
+
+	cache.setWritebackBuffers(0);
+	Verify(testName, cache, cache.getSettings().writebackBuffers == 0);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxDeadlineMT()
+{
+	const char* testName = "TestWhiteBoxDeadlineMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	char buffer[10];
+
+	auto readDeadline = [&cache](DataAddress address, DataSize size)
+	{
+		std::unique_ptr<char[]> buffer(new char[size]);
+		return cache.read(address, size, buffer.get(), std::chrono::steady_clock::now() + std::chrono::milliseconds(20));
+	};
+
+	cache.setupPages(2, 10);
+	cache.setHoldRead(true);
+	auto f = std::async(std::launch::async, ReadCache, std::ref(cache), 0, 10);		//page 0 is loading
+	cache.waitHoldRead();
+
+	//Timeout policy: the waiter gives up
+	Verify(testName, cache, cache.read(0, 10, buffer, std::chrono::steady_clock::now() + std::chrono::milliseconds(20)) == false);
+	Verify(testName, cache, cache.write(2, 5, buffer, std::chrono::steady_clock::now() + std::chrono::milliseconds(20)) == false);
+	Verify(testName, cache, cache.countRead == 1 && cache.getStatistic().timeoutCount == 2);
+
+	//Direct read policy: only the requested range is read, the load goes on
+	cache.setDeadlinePolicy(DEADLINE_DIRECT_READ);
+	auto f1 = std::async(std::launch::async, readDeadline, 3, 4);
+	while (cache.countRead < 2)
+	{
+		std::this_thread::yield();
+	}
+	Verify(testName, cache, cache.lastAddressRead == 3 && cache.lastSizeRead == 4);
+
+	cache.setHoldRead(false);
+	f.get();
+	Verify(testName, cache, f1.get() == true);
+	Verify(testName, cache, cache.getStatistic().timeoutCount == 3);
+
+	//The page is loaded: the deadline does not matter
+	Verify(testName, cache, cache.read(0, 10, buffer, std::chrono::steady_clock::now()) == true);
+	Verify(testName, cache, cache.countRead == 2);
+
+	//The storage does not have the data of a page being unloaded: the direct read policy gives up too
+	cache.setupPages(1, 10);
+	cache.write(0, 10, buffer);
+	cache.reset();
+
+	cache.setHoldWrite(true);
+	f = std::async(std::launch::async, ReadCache, std::ref(cache), 10, 10);		//Page 0 is unloading
+	cache.waitHoldWrite();
+	Verify(testName, cache, cache.read(0, 10, buffer, std::chrono::steady_clock::now() + std::chrono::milliseconds(20)) == false);
+	Verify(testName, cache, cache.countRead == 0);
+
+	cache.setHoldWrite(false);
+	f.get();
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxHedgedReadMT()
+{
+	const char* testName = "TestWhiteBoxHedgedReadMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	char buffer[10];
+
+	cache.setupPages(1, 10);
+	cache.setHedgedRead(50);
+	for (DataAddress page = 0; page < 16; page++)
+	{
+		cache.read(page * 10, 10, buffer);		//The latency statistic is collected
+	}
+	Verify(testName, cache, cache.countHedgedRead == 0 && cache.getStatistic().hedgedReadCount == 0);
+
+	cache.setHoldRead(true);
+	cache.read(200, 10, buffer);		//The first read hangs, the hedged one fills the page
+	Verify(testName, cache, cache.countHedgedRead == 1 && ::memcmp(buffer, "hhhhhhhhhh", 10) == 0);
+
+	CacheStatistic statistic = cache.getStatistic();
+	Verify(testName, cache, statistic.hedgedReadCount == 1 && statistic.hedgedWinCount == 1);
+
+	cache.read(205, 5, buffer);			//The page is in the cache
+	Verify(testName, cache, cache.countHedgedRead == 1 && ::memcmp(buffer, "hhhhh", 5) == 0);
+
+	cache.setHoldRead(false);
+	cache.setHedgedRead(0);				//Waits for the first read, its data is dropped
+	Verify(testName, cache, cache.countRead == 17 && cache.getSettings().hedgePercentile == 0);
+
+	//shutdown switches off every feature that runs a thread
+	cache.setHedgedRead(90);
+	cache.setLoadThreads(2);
+	cache.setFreePool(1, 2);
+	cache.setCleanFirst(2, 1);
+	cache.setWritebackBuffers(2);
+	cache.shutdown();
+
+	CacheSettings settings = cache.getSettings();
+	Verify(testName, cache, settings.hedgePercentile == 0 && settings.loadThreads == 0 && settings.freePoolLowWater == 0 &&
+		settings.cleanFirstCount == 0 && settings.writebackBuffers == 0);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxIoLimitMT()
+{
+	const char* testName = "TestWhiteBoxIoLimitMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	char buffer[10];
+
+	auto waitQueueDepth = [&cache](unsigned long depth)
+	{
+		while (cache.getStatistic().ioQueueDepth != depth)
+		{
+			std::this_thread::yield();
+		}
+	};
+
+	cache.setupPages(4, 10);
+	cache.write(20, 10, buffer);	//page 2 is dirty
+	cache.setIoLimit(1, 1);
+	cache.reset();
+	cache.resetStatistic();
+
+	cache.setHoldRead(true);
+	auto f0 = std::async(std::launch::async, ReadCache, std::ref(cache), 0, 10);
+	cache.waitHoldRead();
+	auto f1 = std::async(std::launch::async, ReadCache, std::ref(cache), 10, 10);	//waits for the read limit
+	waitQueueDepth(1);
+	Verify(testName, cache, cache.countRead == 1);
+
+	cache.flush();		//The writes have their own limit
+	Verify(testName, cache, cache.countWrite == 1 && cache.lastAddressWrite == 20);
+
+	cache.setHoldRead(false);
+	f0.get();
+	f1.get();
+	Verify(testName, cache, cache.countRead == 2 && cache.lastAddressRead == 10);
+
+	CacheStatistic statistic = cache.getStatistic();
+	Verify(testName, cache, statistic.ioQueuedCount == 1 && statistic.ioQueueDepth == 0 && statistic.ioMaxQueueDepth == 1);
+
+	cache.setIoLimit(0, 0);
+	Verify(testName, cache, cache.getSettings().readLimit == 0);
+
+	//The demand request passes the background one that waits longer
+	IoLimiter limiter;
+	std::mutex synchronizer;
+	std::vector<IoPriority> order;
+
+	auto request = [&](IoPriority priority)
+	{
+		std::unique_lock<std::mutex> locker(synchronizer);
+		limiter.acquire(locker, priority);
+		order.push_back(priority);
+		limiter.release();
+	};
+	auto waitLimiterDepth = [&](size_t depth)
+	{
+		std::unique_lock<std::mutex> locker(synchronizer);
+		while (limiter.getQueueDepth() != depth)
+		{
+			locker.unlock();
+			std::this_thread::yield();
+			locker.lock();
+		}
+	};
+
+	limiter.setLimit(1);
+	{
+		std::unique_lock<std::mutex> locker(synchronizer);
+		limiter.acquire(locker, IO_DEMAND);
+	}
+	auto f2 = std::async(std::launch::async, request, IO_BACKGROUND);
+	waitLimiterDepth(1);
+	auto f3 = std::async(std::launch::async, request, IO_DEMAND);
+	waitLimiterDepth(2);
+	{
+		std::unique_lock<std::mutex> locker(synchronizer);
+		limiter.release();
+	}
+	f2.get();
+	f3.get();
+	Verify(testName, cache, order.size() == 2 && order[0] == IO_DEMAND && order[1] == IO_BACKGROUND);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxSchedulerMT()
+{
+	const char* testName = "TestWhiteBoxSchedulerMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	char buffer[10];
+
+	cache.setupPages(4, 10);
+	cache.setIoScheduler(200000);
+
+	//Two misses from different threads in one window: one storage call
+	auto f0 = std::async(std::launch::async, ReadCache, std::ref(cache), 10, 10);
+	auto f1 = std::async(std::launch::async, ReadCache, std::ref(cache), 0, 10);
+	f0.get();
+	f1.get();
+	Verify(testName, cache, cache.countRead == 1 && cache.lastAddressRead == 0 && cache.lastSizeRead == 20);
+	Verify(testName, cache, cache.getStatistic().ioMergedCount == 1);
+
+	//Not adjacent pages are read one by one in the address order
+	cache.write(30, 5, buffer);
+	Verify(testName, cache, cache.countRead == 2 && cache.lastAddressRead == 30 && cache.lastSizeRead == 10);
+
+	cache.setIoScheduler(0);
+	cache.flush();
+	Verify(testName, cache, cache.countWrite == 1 && cache.lastAddressWrite == 30);
+	Verify(testName, cache, cache.getSettings().schedulerWindow == 0);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxLoadThreadsMT()
+{
+	const char* testName = "TestWhiteBoxLoadThreadsMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	cache.setupPages(8, 10);
+	cache.setLoadThreads(3);
+
+	//All pages of one request are loaded at the same time: the first by the caller, the next ones by one vector
+	cache.setHoldRead(true);
+	auto f = std::async(std::launch::async, ReadCache, std::ref(cache), 5, 35);
+	while (cache.countRead < 2 || cache.countReadV < 1)
+	{
+		std::this_thread::yield();
+	}
+	cache.setHoldRead(false);
+	f.get();
+	Verify(testName, cache, cache.countRead == 4 && cache.getStatistic().missCount == 4 && cache.getStatistic().hitCount == 0);
+	Verify(testName, cache, cache.countReadV == 1 && cache.lastRangesRead == 3);
+
+	std::vector<std::pair<unsigned long, unsigned long>> readInfo;
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	Verify(testName, cache, readInfo.size() == 4);
+
+	//A request larger than the cache
+	ReadCache(cache, 100, 120);
+	Verify(testName, cache, cache.countRead == 16 && cache.lastAddressRead == 210);
+
+	//The loaders are stopped while the slot table is rebuilt and started again
+	cache.setupPages(8, 10);
+	cache.reset();
+	ReadCache(cache, 5, 35);
+	Verify(testName, cache, cache.countRead == 4 && cache.getSettings().loadThreads == 3);
+
+	cache.clear();
+	ReadCache(cache, 5, 35);
+	Verify(testName, cache, cache.countRead == 8 && cache.getSettings().loadThreads == 3);
+
+	//A page loaded ahead is referenced once, by the first touch of the caller: ARC keeps it in T1
+	cache.setupPages(4, 10);
+	cache.setReplaceAlgoritm(ALG_ARC);
+	cache.resetStatistic();
+	cache.reset();
+	cache.setHoldRead(true);
+	auto f1 = std::async(std::launch::async, ReadCache, std::ref(cache), 0, 40);
+	while (cache.countRead < 2 || cache.countReadV < 1)
+	{
+		std::this_thread::yield();
+	}
+	cache.setHoldRead(false);
+	f1.get();
+	CacheStatistic statistic = cache.getStatistic();
+	Verify(testName, cache, statistic.missCount == 4 && statistic.hitCount == 0);
+
+	ReadCache(cache, 0, 10);				//Page 0 moves to T2, pages 1-3 are evicted first
+	for (DataAddress page = 4; page < 7; page++)
+	{
+		ReadCache(cache, page * 10, 10);
+	}
+
+	std::vector<PageNumber> pages;
+	cache.getDebugInfo(readInfo, DBINFO_LOCATION_TABLE);
+	for (auto& location : readInfo)
+	{
+		pages.push_back(location.first);
+	}
+	std::sort(pages.begin(), pages.end());
+	Verify(testName, cache, pages == std::vector<PageNumber>({ 0, 4, 5, 6 }));
+
+	//The pages loaded ahead and not read again are evicted without a hit, so the streams go around the cache
+	cache.setupPages(4, 10);
+	cache.setBypass(0, 0.9);
+	cache.resetStatistic();
+	for (DataAddress page = 10; page < 90; page += 2)
+	{
+		ReadCache(cache, page * 10, 20);
+	}
+	Verify(testName, cache, cache.getStatistic().bypassCount == 6);
+	cache.setBypass(0, 0);
+
+	cache.setLoadThreads(0);
+	Verify(testName, cache, cache.getSettings().loadThreads == 0);
+
+	printf("Successfull\n");
+}
+
+void TestWhiteBoxVectorIoMT()
+{
+	const char* testName = "TestWhiteBoxVectorIoMT";
+
+	printf("%s\n", testName);
+
+	TestCacheMTWhiteBox cache;
+
+	char buffer[10] = "data";
+
+	cache.setupPages(4, 10);
+	cache.write(30, 10, buffer);
+	cache.write(0, 10, buffer);
+	cache.write(20, 10, buffer);
+	cache.reset();
+
+	//All dirty pages are one vector in the address order
+	cache.flush();
+	Verify(testName, cache, cache.countWriteV == 1 && cache.lastRangesWrite == 3);
+	Verify(testName, cache, cache.countWrite == 3 && cache.lastAddressWrite == 30);
+
+	//One page does not need a vector
+	cache.write(10, 10, buffer);
+	cache.flush(0, 40);
+	Verify(testName, cache, cache.countWriteV == 1 && cache.countWrite == 4 && cache.lastAddressWrite == 10);
+
+	//The scheduler sends the not adjacent misses of one window as one vector
+	cache.reset();
+	cache.setIoScheduler(200000);
+	auto f0 = std::async(std::launch::async, ReadCache, std::ref(cache), 70, 10);
+	auto f1 = std::async(std::launch::async, ReadCache, std::ref(cache), 50, 10);
+	f0.get();
+	f1.get();
+	Verify(testName, cache, cache.countReadV == 1 && cache.lastRangesRead == 2);
+	Verify(testName, cache, cache.countRead == 2 && cache.lastAddressRead == 70);
+
+	//The adjacent misses with different metaData are neither merged nor one vector
+	auto readMetaData = [&cache](DataAddress address, void* metaData)
+	{
+		char data[10];
+		cache.read(address, 10, data, metaData);
+	};
+	int metaData[2] = { 0, 1 };
+
+	cache.reset();
+	auto f2 = std::async(std::launch::async, readMetaData, 90, &metaData[0]);
+	auto f3 = std::async(std::launch::async, readMetaData, 100, &metaData[1]);
+	f2.get();
+	f3.get();
+	Verify(testName, cache, cache.countReadV == 0 && cache.countRead == 2 && cache.getStatistic().ioMergedCount == 0);
+
+	cache.setIoScheduler(0);
+
+	//The flush is split in chunks of 1 MB: four pages of 256 KB, then the last page alone
+	const PageSize bigPageSize = 256 * 1024;
+
+	cache.setupPages(5, bigPageSize);
+	for (DataAddress page = 0; page < 5; page++)
+	{
+		cache.write(page * bigPageSize, 10, buffer);
+	}
+	cache.reset();
+	cache.flush();
+	Verify(testName, cache, cache.countWriteV == 1 && cache.lastRangesWrite == 4);
+	Verify(testName, cache, cache.countWrite == 5 && cache.lastAddressWrite == 4 * bigPageSize);
+
 	printf("Successfull\n");
 }
 
@@ -266,18 +943,18 @@ void TestWhiteBoxExceptionMT()
 
 	auto write = [&cache](DataAddress address, DataSize size)
 	{
-		std::unique_ptr<char> buffer(new char[size]);
+		std::unique_ptr<char[]> buffer(new char[size]);
 		cache.write(address, size, buffer.get());
 	};
 	auto read = [&cache](DataAddress address, DataSize size)
 	{
-		std::unique_ptr<char> buffer(new char[size]);
+		std::unique_ptr<char[]> buffer(new char[size]);
 		cache.read(address, size, buffer.get());
 	};
 
 	auto writeException = [&cache](DataAddress address, DataSize size)
 	{
-		std::unique_ptr<char> buffer(new char[size]);
+		std::unique_ptr<char[]> buffer(new char[size]);
 		try
 		{
 			cache.write(address, size, buffer.get());
@@ -290,7 +967,7 @@ void TestWhiteBoxExceptionMT()
 	};
 	auto readException = [&cache](DataAddress address, DataSize size)
 	{
-		std::unique_ptr<char> buffer(new char[size]);
+		std::unique_ptr<char[]> buffer(new char[size]);
 		try
 		{
 			cache.read(address, size, buffer.get());